@@ -0,0 +1,388 @@
+/*
+GC Benchmark Suite (C17, header-only)
+
+Synthetic allocation workloads shared by mark_and_sweep.c and
+refcounting_gc.c. Each collector describes itself with a gc_bench_ops_t
+and calls gcBenchMain(); the workloads only talk to the collector through
+those operations, so both collectors run exactly the same mutator code.
+
+Workloads:
+    binary-trees    Build, walk and drop complete binary trees of growing depth
+                    next to one long-lived tree
+    cache-churn     A long-lived two-level cache whose entries are replaced
+                    at random
+    cyclic-lists    Doubly-linked rings, a few kept alive at a time
+    random-graph    Random graphs with cycles, rewired edge by edge, replaced
+                    every round
+
+Each run prints one CSV row per workload:
+    collector,workload,scale,seconds,operations,ops_per_sec,allocations,
+    allocs_per_sec,pauses,max_pause_ms,p99_pause_ms,peak_rss_kb
+Pauses are whatever the collector reports through gcBenchRecordPause().
+Peak RSS is the process high-water mark, so run one workload per process
+to get per-workload numbers.
+
+Object contract: allocate() returns an object the caller holds one
+reference to. It must be linked from a reachable object or pushed as a
+root before the next allocate(), and then given up with release().
+
+Code Structure:
+Includes
+Constants & Macros
+Struct Definitions
+Global Variables
+Function Definitions
+*/
+
+#ifndef GC_BENCH_H
+#define GC_BENCH_H
+
+//  Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#if defined(_MSC_VER) || defined(__clang__)
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+//  Constants & Macros
+#define GC_BENCH_TREES_MIN_DEPTH 4
+#define GC_BENCH_TREES_MAX_DEPTH 16
+#define GC_BENCH_CACHE_BUCKETS 2048
+#define GC_BENCH_CACHE_BUCKET_SIZE 64
+#define GC_BENCH_CACHE_OPERATIONS 2000000
+#define GC_BENCH_RING_LENGTH 1000
+#define GC_BENCH_RINGS 2000
+#define GC_BENCH_RINGS_LIVE 8
+#define GC_BENCH_GRAPH_NODES 10000
+#define GC_BENCH_GRAPH_DEGREE 4
+#define GC_BENCH_GRAPH_REWIRES 50000                    //  Edge rewires per graph
+#define GC_BENCH_GRAPHS 200
+#define GC_BENCH_GRAPHS_LIVE 2
+#define GC_BENCH_PAUSES_INITIAL 1024
+
+//  Struct Definitions
+typedef struct GcBenchOps {
+    const char *collector;
+    void *(*allocate)(const char *name);
+    void (*link)(void *from, void *to);
+    void (*unlink)(void *from, void *to);               //  Removes the first from -> to edge
+    void *(*child)(void *object, int index);            //  NULL past the last reference
+    void (*pushRoot)(void *object);
+    void (*popRoot)(void);
+    void (*release)(void *object);                      //  Drops the reference allocate() returned
+    void (*collect)(void);                              //  Full collection at the end of a workload
+} gc_bench_ops_t;
+
+typedef struct GcBenchResult {
+    size_t operations;
+    size_t allocations;
+    int failed;
+} gc_bench_result_t;
+
+typedef struct GcBenchWorkload {
+    const char *name;
+    void (*run)(const gc_bench_ops_t *ops, size_t scale, gc_bench_result_t *result);
+} gc_bench_workload_t;
+
+//  Global Variables
+static double *gc_bench_pauses = NULL;
+static size_t gc_bench_pause_count = 0;
+static size_t gc_bench_pause_capacity = 0;
+static int gc_bench_recording = 0;
+static uint64_t gc_bench_random_state = 0x9E3779B97F4A7C15ULL;
+
+//  Function Definitions
+//  Called by the collectors for every mutator pause; free when no benchmark runs
+static inline void gcBenchRecordPause(double seconds) {
+    if (!gc_bench_recording) return;
+    if (gc_bench_pause_count == gc_bench_pause_capacity) {
+        size_t new_capacity = gc_bench_pause_capacity ? gc_bench_pause_capacity * 2 : GC_BENCH_PAUSES_INITIAL;
+        double *pauses = realloc(gc_bench_pauses, new_capacity * sizeof(*pauses));
+        if (!pauses) return;                            //  Drop the sample rather than abort the run
+        gc_bench_pauses = pauses;
+        gc_bench_pause_capacity = new_capacity;
+    }
+    gc_bench_pauses[gc_bench_pause_count++] = seconds;
+}
+
+static inline uint64_t gcBenchRandom(void) {
+    gc_bench_random_state ^= gc_bench_random_state << 13;
+    gc_bench_random_state ^= gc_bench_random_state >> 7;
+    gc_bench_random_state ^= gc_bench_random_state << 17;
+    return gc_bench_random_state;
+}
+
+static inline double gcBenchElapsed(const struct timespec *start) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static inline size_t gcBenchPeakRssKb(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return (size_t)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss / 1024;              //  Bytes on macOS
+#else
+    return (size_t)usage.ru_maxrss;                     //  Kilobytes on Linux
+#endif
+#endif
+}
+
+static inline int gcBenchCompareDoubles(const void *a, const void *b) {
+    double left = *(const double *)a;
+    double right = *(const double *)b;
+    return (left > right) - (left < right);
+}
+
+static inline void *gcBenchAllocate(const gc_bench_ops_t *ops, gc_bench_result_t *result, const char *name) {
+    result->allocations++;
+    return ops->allocate(name);
+}
+
+//  Top-down so every new node is reachable before the next allocation
+static inline void gcBenchBuildTree(const gc_bench_ops_t *ops, gc_bench_result_t *result, void *parent, int depth) {
+    void *node = gcBenchAllocate(ops, result, "tree");
+    ops->link(parent, node);
+    ops->release(node);
+    if (depth > 0) {
+        gcBenchBuildTree(ops, result, node, depth - 1);
+        gcBenchBuildTree(ops, result, node, depth - 1);
+    }
+}
+
+static inline size_t gcBenchCountTree(const gc_bench_ops_t *ops, void *node) {
+    size_t count = 1;
+    void *child;
+    for (int i = 0; (child = ops->child(node, i)) != NULL; i++) count += gcBenchCountTree(ops, child);
+    return count;
+}
+
+//  Trees hang off a rooted holder so the root node itself is an ordinary child
+static inline void gcBenchBinaryTrees(const gc_bench_ops_t *ops, size_t scale, gc_bench_result_t *result) {
+    void *long_lived = gcBenchAllocate(ops, result, "holder");
+    ops->pushRoot(long_lived);
+    ops->release(long_lived);
+    gcBenchBuildTree(ops, result, long_lived, GC_BENCH_TREES_MAX_DEPTH);
+
+    for (int depth = GC_BENCH_TREES_MIN_DEPTH; depth <= GC_BENCH_TREES_MAX_DEPTH; depth += 2) {
+        size_t iterations = ((size_t)1 << (GC_BENCH_TREES_MAX_DEPTH - depth + GC_BENCH_TREES_MIN_DEPTH)) * scale;
+        size_t expected = ((size_t)1 << (depth + 1)) - 1;
+        for (size_t i = 0; i < iterations; i++) {
+            void *holder = gcBenchAllocate(ops, result, "holder");
+            ops->pushRoot(holder);
+            ops->release(holder);
+            gcBenchBuildTree(ops, result, holder, depth);
+            if (gcBenchCountTree(ops, ops->child(holder, 0)) != expected) result->failed = 1;
+            ops->popRoot();
+            result->operations++;
+        }
+    }
+
+    if (gcBenchCountTree(ops, ops->child(long_lived, 0)) != ((size_t)1 << (GC_BENCH_TREES_MAX_DEPTH + 1)) - 1) {
+        result->failed = 1;
+    }
+    ops->popRoot();
+}
+
+//  cache -> buckets -> entries -> payload; each operation replaces one entry
+static inline void gcBenchCacheChurn(const gc_bench_ops_t *ops, size_t scale, gc_bench_result_t *result) {
+    void **buckets = malloc(GC_BENCH_CACHE_BUCKETS * sizeof(*buckets));
+    if (!buckets) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    void *cache = gcBenchAllocate(ops, result, "cache");
+    ops->pushRoot(cache);
+    ops->release(cache);
+    for (size_t b = 0; b < GC_BENCH_CACHE_BUCKETS; b++) {
+        buckets[b] = gcBenchAllocate(ops, result, "bucket");
+        ops->link(cache, buckets[b]);
+        ops->release(buckets[b]);
+        for (int e = 0; e < GC_BENCH_CACHE_BUCKET_SIZE; e++) {
+            void *entry = gcBenchAllocate(ops, result, "entry");
+            ops->link(buckets[b], entry);
+            ops->release(entry);
+            void *payload = gcBenchAllocate(ops, result, "payload");
+            ops->link(entry, payload);
+            ops->release(payload);
+        }
+    }
+
+    size_t operations = GC_BENCH_CACHE_OPERATIONS * scale;
+    for (size_t i = 0; i < operations; i++) {
+        uint64_t random = gcBenchRandom();
+        void *bucket = buckets[random % GC_BENCH_CACHE_BUCKETS];
+        void *victim = ops->child(bucket, (int)((random >> 32) % GC_BENCH_CACHE_BUCKET_SIZE));
+        ops->unlink(bucket, victim);
+
+        void *entry = gcBenchAllocate(ops, result, "entry");
+        ops->link(bucket, entry);
+        ops->release(entry);
+        void *payload = gcBenchAllocate(ops, result, "payload");
+        ops->link(entry, payload);
+        ops->release(payload);
+        result->operations++;
+    }
+
+    ops->popRoot();
+    free(buckets);
+}
+
+//  Every ring is a cycle: reference counting alone can never reclaim it
+static inline void gcBenchCyclicLists(const gc_bench_ops_t *ops, size_t scale, gc_bench_result_t *result) {
+    void *holder = gcBenchAllocate(ops, result, "rings");
+    ops->pushRoot(holder);
+    ops->release(holder);
+
+    size_t rings = GC_BENCH_RINGS * scale;
+    for (size_t r = 0; r < rings; r++) {
+        if (r >= GC_BENCH_RINGS_LIVE) ops->unlink(holder, ops->child(holder, 0));
+
+        void *head = gcBenchAllocate(ops, result, "ring");
+        ops->link(holder, head);
+        ops->release(head);
+        void *previous = head;
+        for (int i = 1; i < GC_BENCH_RING_LENGTH; i++) {
+            void *node = gcBenchAllocate(ops, result, "ring");
+            ops->link(previous, node);
+            ops->link(node, previous);
+            ops->release(node);
+            previous = node;
+        }
+        ops->link(previous, head);
+        ops->link(head, previous);
+        result->operations++;
+    }
+
+    ops->popRoot();
+}
+
+//  Each graph: a holder owning every node, random edges between the nodes,
+//  then GC_BENCH_GRAPH_REWIRES single-edge rewires
+static inline void gcBenchRandomGraph(const gc_bench_ops_t *ops, size_t scale, gc_bench_result_t *result) {
+    void **nodes = malloc(GC_BENCH_GRAPH_NODES * sizeof(*nodes));
+    if (!nodes) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    void *holder = gcBenchAllocate(ops, result, "graphs");
+    ops->pushRoot(holder);
+    ops->release(holder);
+
+    size_t graphs = GC_BENCH_GRAPHS * scale;
+    for (size_t g = 0; g < graphs; g++) {
+        if (g >= GC_BENCH_GRAPHS_LIVE) ops->unlink(holder, ops->child(holder, 0));
+
+        void *graph = gcBenchAllocate(ops, result, "graph");
+        ops->link(holder, graph);
+        ops->release(graph);
+        for (size_t i = 0; i < GC_BENCH_GRAPH_NODES; i++) {
+            nodes[i] = gcBenchAllocate(ops, result, "vertex");
+            ops->link(graph, nodes[i]);
+            ops->release(nodes[i]);
+        }
+        for (size_t i = 0; i < GC_BENCH_GRAPH_NODES; i++) {
+            for (int d = 0; d < GC_BENCH_GRAPH_DEGREE; d++) {
+                ops->link(nodes[i], nodes[gcBenchRandom() % GC_BENCH_GRAPH_NODES]);
+                result->operations++;
+            }
+        }
+        for (size_t i = 0; i < GC_BENCH_GRAPH_REWIRES; i++) {
+            void *from = nodes[gcBenchRandom() % GC_BENCH_GRAPH_NODES];
+            void *old_target = ops->child(from, 0);
+            if (old_target) ops->unlink(from, old_target);
+            ops->link(from, nodes[gcBenchRandom() % GC_BENCH_GRAPH_NODES]);
+            result->operations++;
+        }
+    }
+
+    ops->popRoot();
+    free(nodes);
+}
+
+static const gc_bench_workload_t gc_bench_workloads[] = {
+    { "binary-trees", gcBenchBinaryTrees },
+    { "cache-churn", gcBenchCacheChurn },
+    { "cyclic-lists", gcBenchCyclicLists },
+    { "random-graph", gcBenchRandomGraph },
+};
+
+static inline void gcBenchPrintHeader(void) {
+    printf("collector,workload,scale,seconds,operations,ops_per_sec,allocations,allocs_per_sec,"
+           "pauses,max_pause_ms,p99_pause_ms,peak_rss_kb\n");
+}
+
+//  Runs one workload (including its final collection) and prints its CSV row
+static inline int gcBenchRun(const gc_bench_ops_t *ops, const gc_bench_workload_t *workload, size_t scale) {
+    gc_bench_result_t result = { 0, 0, 0 };
+    gc_bench_pause_count = 0;
+    gc_bench_random_state = 0x9E3779B97F4A7C15ULL;
+    gc_bench_recording = 1;
+
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    workload->run(ops, scale, &result);
+    ops->collect();
+    double seconds = gcBenchElapsed(&start);
+    gc_bench_recording = 0;
+
+    double max_pause = 0.0, p99_pause = 0.0;
+    if (gc_bench_pause_count > 0) {
+        qsort(gc_bench_pauses, gc_bench_pause_count, sizeof(*gc_bench_pauses), gcBenchCompareDoubles);
+        max_pause = gc_bench_pauses[gc_bench_pause_count - 1];
+        p99_pause = gc_bench_pauses[(gc_bench_pause_count - 1) * 99 / 100];
+    }
+
+    printf("%s,%s,%zu,%.3f,%zu,%.0f,%zu,%.0f,%zu,%.4f,%.4f,%zu\n", ops->collector, workload->name, scale, seconds,
+           result.operations, seconds > 0.0 ? (double)result.operations / seconds : 0.0, result.allocations,
+           seconds > 0.0 ? (double)result.allocations / seconds : 0.0, gc_bench_pause_count, max_pause * 1e3,
+           p99_pause * 1e3, gcBenchPeakRssKb());
+    fflush(stdout);
+    if (result.failed) fprintf(stderr, "ERROR: %s/%s produced a wrong object graph\n", ops->collector, workload->name);
+    return !result.failed;
+}
+
+//  name is a workload name or "all"; returns EXIT_SUCCESS or EXIT_FAILURE
+static inline int gcBenchMain(const gc_bench_ops_t *ops, const char *name, size_t scale) {
+    size_t workload_count = sizeof(gc_bench_workloads) / sizeof(gc_bench_workloads[0]);
+    int found = 0, ok = 1;
+    if (scale == 0) scale = 1;
+
+    gcBenchPrintHeader();
+    for (size_t i = 0; i < workload_count; i++) {
+        if (strcmp(name, "all") != 0 && strcmp(name, gc_bench_workloads[i].name) != 0) continue;
+        found = 1;
+        ok = gcBenchRun(ops, &gc_bench_workloads[i], scale) && ok;
+    }
+
+    free(gc_bench_pauses);
+    gc_bench_pauses = NULL;
+    gc_bench_pause_capacity = 0;
+    if (!found) {
+        fprintf(stderr, "ERROR: Unknown workload %s (expected all", name);
+        for (size_t i = 0; i < workload_count; i++) fprintf(stderr, ", %s", gc_bench_workloads[i].name);
+        fprintf(stderr, ")\n");
+        return EXIT_FAILURE;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif // GC_BENCH_H
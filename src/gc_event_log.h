@@ -0,0 +1,298 @@
+/*
+GC Event Log (C17, header-only)
+
+Buffered, asynchronous event log shared by mark_and_sweep.c and
+refcounting_gc.c. Logging an event copies a fixed-size binary record into
+the calling thread's single-producer ring buffer; nothing is formatted and
+no system call is made on that path. A background writer thread drains
+every ring and either renders the records as text (GC_LOG_FORMAT_TEXT, the
+same lines the collectors used to fprintf) or appends them verbatim to a
+binary file (GC_LOG_FORMAT_BINARY) that gc_log_decoder.c turns back into
+text later.
+
+Order is exact within one thread; records from different threads are
+interleaved at ring granularity. A full ring makes its producer wait for
+the writer, so no event is ever dropped.
+
+GC_LOG_LEVEL selects what is compiled in:
+    GC_LOG_LEVEL_NONE     nothing
+    GC_LOG_LEVEL_PHASE    phase banners, roots, reports
+    GC_LOG_LEVEL_OBJECT   also per-object events (default unless NDEBUG)
+
+Code Structure:
+Includes
+Constants & Macros
+Struct Definitions
+Global Variables
+Function Definitions
+*/
+
+#ifndef GC_EVENT_LOG_H
+#define GC_EVENT_LOG_H
+
+//  Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include <time.h>
+
+//  Constants & Macros
+#define GC_LOG_LEVEL_NONE 0
+#define GC_LOG_LEVEL_PHASE 1
+#define GC_LOG_LEVEL_OBJECT 2
+
+#ifndef GC_LOG_LEVEL
+#ifdef NDEBUG
+#define GC_LOG_LEVEL GC_LOG_LEVEL_PHASE
+#else
+#define GC_LOG_LEVEL GC_LOG_LEVEL_OBJECT
+#endif
+#endif
+
+#define GC_LOG_FORMAT_TEXT 0
+#define GC_LOG_FORMAT_BINARY 1
+
+#define GC_LOG_MAGIC "GCLOG01"                          //  8 bytes with the terminator
+#define GC_LOG_RECORD_SIZE 128
+#define GC_LOG_TEXT_BYTES (GC_LOG_RECORD_SIZE - 8)      //  Payload after the record header
+#define GC_LOG_RING_RECORDS 16384                       //  Per thread, power of two
+#define GC_LOG_FORMAT_BUFFER 1024                       //  Longest formatted text event
+#define GC_LOG_IDLE_SLEEP_MICROS 200                    //  Writer back-off when every ring is empty
+
+//  Per-object events vanish from builds below GC_LOG_LEVEL_OBJECT
+#if GC_LOG_LEVEL >= GC_LOG_LEVEL_OBJECT
+#define GC_LOG_OBJECT(kind, first, second, number) gcLogEvent((kind), (first), (second), (number))
+#else
+#define GC_LOG_OBJECT(kind, first, second, number) ((void)0)
+#endif
+
+#if GC_LOG_LEVEL >= GC_LOG_LEVEL_PHASE
+#define GC_LOG_PHASE(kind, first, second, number) gcLogEvent((kind), (first), (second), (number))
+#define GC_LOG_TEXT(...) gcLogText(__VA_ARGS__)
+#else
+#define GC_LOG_PHASE(kind, first, second, number) ((void)0)
+#define GC_LOG_TEXT(...) ((void)0)
+#endif
+
+//  Struct Definitions
+//  The render format of each kind is in gcLogRender()
+typedef enum GcEventKind {
+    GC_EVENT_TEXT = 0,                                  //  Preformatted text chunk
+    GC_EVENT_ALLOC,                                     //  mark_and_sweep.c events
+    GC_EVENT_ADD_REF,
+    GC_EVENT_REMOVE_REF,
+    GC_EVENT_MARK,
+    GC_EVENT_FREE,
+    GC_EVENT_PUSH_ROOT,
+    GC_EVENT_POP_ROOT,
+    GC_EVENT_RC_CREATE,                                 //  refcounting_gc.c events
+    GC_EVENT_RC_RETAIN,
+    GC_EVENT_RC_RELEASE,
+    GC_EVENT_RC_FREE,
+    GC_EVENT_RC_FORCE_FREE,
+    GC_EVENT_KIND_COUNT
+} gc_event_kind_t;
+
+//  One event: up to two NUL-terminated strings packed into text, plus a number
+typedef struct GcLogRecord {
+    uint8_t kind;
+    uint8_t reserved;                                   //  Always zero; keeps text_length aligned
+    uint16_t text_length;                               //  Bytes of text in use
+    int32_t number;
+    char text[GC_LOG_TEXT_BYTES];
+} gc_log_record_t;
+
+_Static_assert(sizeof(gc_log_record_t) == GC_LOG_RECORD_SIZE, "log records must be exactly GC_LOG_RECORD_SIZE bytes");
+
+//  Single-producer ring; head and tail only ever increase
+typedef struct GcLogRing {
+    atomic_size_t head;                                 //  Next record the owner writes
+    char head_pad[64 - sizeof(atomic_size_t)];
+    atomic_size_t tail;                                 //  Next record the writer reads
+    char tail_pad[64 - sizeof(atomic_size_t)];
+    struct GcLogRing *next;
+    gc_log_record_t records[GC_LOG_RING_RECORDS];
+} gc_log_ring_t;
+
+//  Global Variables
+static FILE *gc_log_file = NULL;
+static int gc_log_format = GC_LOG_FORMAT_TEXT;
+static thrd_t gc_log_writer;
+static atomic_int gc_log_running;
+static _Atomic(gc_log_ring_t *) gc_log_rings = NULL;    //  Every ring ever attached, newest first
+static thread_local gc_log_ring_t *gc_log_thread_ring = NULL;
+
+//  Function Definitions
+//  Renders one record as the text line the collectors historically wrote
+static inline void gcLogRender(FILE *out, const gc_log_record_t *record) {
+    const char *first = record->text;
+    const char *second = first + strlen(first) + 1;
+    switch ((gc_event_kind_t)record->kind) {
+    case GC_EVENT_TEXT: fwrite(record->text, 1, record->text_length, out); break;
+    case GC_EVENT_ALLOC: fprintf(out, "ALLOC: %s = %s\n", first, second); break;
+    case GC_EVENT_ADD_REF: fprintf(out, "ADD_REF: %s -> %s\n", first, second); break;
+    case GC_EVENT_REMOVE_REF: fprintf(out, "REMOVE_REF: %s -/-> %s\n", first, second); break;
+    case GC_EVENT_MARK: fprintf(out, "MARK: %s\n", first); break;
+    case GC_EVENT_FREE: fprintf(out, "FREE: %s (value=%s)\n", first, second); break;
+    case GC_EVENT_PUSH_ROOT: fprintf(out, "PUSH_ROOT: %s\n", first); break;
+    case GC_EVENT_POP_ROOT: fprintf(out, "POP_ROOT (now %d roots)\n", (int)record->number); break;
+    case GC_EVENT_RC_CREATE: fprintf(out, "Created %s = %s (refs = %d)\n", first, second, (int)record->number); break;
+    case GC_EVENT_RC_RETAIN: fprintf(out, "Retained %s (refs = %d)\n", first, (int)record->number); break;
+    case GC_EVENT_RC_RELEASE: fprintf(out, "Released %s (refs = %d)\n", first, (int)record->number); break;
+    case GC_EVENT_RC_FREE: fprintf(out, "Freeing %s\n", first); break;
+    case GC_EVENT_RC_FORCE_FREE: fprintf(out, "Force cleanup: %s\n", first); break;
+    default: fprintf(out, "UNKNOWN EVENT %u\n", (unsigned)record->kind); break;
+    }
+}
+
+//  Writer side: move everything published so far out of one ring
+static inline size_t gcLogDrainRing(gc_log_ring_t *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    for (size_t i = tail; i != head; i++) {
+        const gc_log_record_t *record = &ring->records[i & (GC_LOG_RING_RECORDS - 1)];
+        if (gc_log_format == GC_LOG_FORMAT_BINARY) fwrite(record, sizeof(*record), 1, gc_log_file);
+        else gcLogRender(gc_log_file, record);
+    }
+    atomic_store_explicit(&ring->tail, head, memory_order_release);
+    return head - tail;
+}
+
+static inline int gcLogWriterMain(void *arg) {
+    (void)arg;
+    for (;;) {
+        int stopping = !atomic_load(&gc_log_running);
+        size_t drained = 0;
+        for (gc_log_ring_t *ring = atomic_load(&gc_log_rings); ring; ring = ring->next) {
+            drained += gcLogDrainRing(ring);
+        }
+        if (stopping) break;                            //  The final pass ran after producers stopped
+        if (drained == 0) {
+            struct timespec idle = { 0, GC_LOG_IDLE_SLEEP_MICROS * 1000L };
+            thrd_sleep(&idle, NULL);
+        }
+    }
+    fflush(gc_log_file);
+    return 0;
+}
+
+//  Rings are never unlinked, so a thread that exits still gets drained
+static inline gc_log_ring_t *gcLogAttachThread(void) {
+    gc_log_ring_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        fprintf(stderr, "ERROR: Log ring allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->next = atomic_load(&gc_log_rings);
+    while (!atomic_compare_exchange_weak(&gc_log_rings, &ring->next, ring)) {
+    }
+    gc_log_thread_ring = ring;
+    return ring;
+}
+
+//  Producer side: copy the event into this thread's ring and publish it
+static inline void gcLogEvent(gc_event_kind_t kind, const char *first, const char *second, int number) {
+    if (!gc_log_file) return;
+    gc_log_ring_t *ring = gc_log_thread_ring ? gc_log_thread_ring : gcLogAttachThread();
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == GC_LOG_RING_RECORDS) {
+        thrd_yield();                                   //  Full: wait for the writer
+    }
+
+    gc_log_record_t *record = &ring->records[head & (GC_LOG_RING_RECORDS - 1)];
+    record->kind = (uint8_t)kind;
+    record->number = number;
+
+    //  Both strings share the payload; overlong ones are truncated
+    size_t first_length = first ? strlen(first) : 0;
+    if (first_length > GC_LOG_TEXT_BYTES - 2) first_length = GC_LOG_TEXT_BYTES - 2;
+    if (first_length) memcpy(record->text, first, first_length);
+    record->text[first_length] = '\0';
+
+    size_t room = GC_LOG_TEXT_BYTES - first_length - 2;
+    size_t second_length = second ? strlen(second) : 0;
+    if (second_length > room) second_length = room;
+    if (second_length) memcpy(record->text + first_length + 1, second, second_length);
+    record->text[first_length + 1 + second_length] = '\0';
+    record->text_length = (uint16_t)(first_length + second_length + 2);
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+//  Free-form text, split into as many GC_EVENT_TEXT records as it needs
+static inline void gcLogVText(const char *format, va_list args) {
+    if (!gc_log_file) return;
+    char buffer[GC_LOG_FORMAT_BUFFER];
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    if (length < 0) return;
+    if ((size_t)length >= sizeof(buffer)) length = (int)sizeof(buffer) - 1;
+
+    gc_log_ring_t *ring = gc_log_thread_ring ? gc_log_thread_ring : gcLogAttachThread();
+    for (int offset = 0; offset < length; offset += GC_LOG_TEXT_BYTES) {
+        size_t chunk = (size_t)(length - offset);
+        if (chunk > GC_LOG_TEXT_BYTES) chunk = GC_LOG_TEXT_BYTES;
+
+        size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        while (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == GC_LOG_RING_RECORDS) {
+            thrd_yield();
+        }
+        gc_log_record_t *record = &ring->records[head & (GC_LOG_RING_RECORDS - 1)];
+        record->kind = GC_EVENT_TEXT;
+        record->number = 0;
+        record->text_length = (uint16_t)chunk;
+        memcpy(record->text, buffer + offset, chunk);
+        atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    }
+}
+
+static inline void gcLogText(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    gcLogVText(format, args);
+    va_end(args);
+}
+
+//  Stops the writer after a final drain; safe to call more than once
+static inline void gcLogClose(void) {
+    if (!gc_log_file) return;
+    atomic_store(&gc_log_running, 0);
+    thrd_join(gc_log_writer, NULL);
+    fclose(gc_log_file);
+    gc_log_file = NULL;
+}
+
+//  Binary logs start with GC_LOG_MAGIC and are followed by raw records.
+//  gcLogClose() is also registered with atexit() so error exits keep their log.
+static inline int gcLogOpen(const char *path, int format) {
+    if (gc_log_file) return 1;
+    errno_t error = fopen_s(&gc_log_file, path, format == GC_LOG_FORMAT_BINARY ? "wb" : "w");
+    if (error != 0 || gc_log_file == NULL) {
+        gc_log_file = NULL;
+        return 0;
+    }
+    gc_log_format = format;
+    if (format == GC_LOG_FORMAT_BINARY) fwrite(GC_LOG_MAGIC, 1, sizeof(GC_LOG_MAGIC), gc_log_file);
+
+    static int exit_hook_registered = 0;
+    if (!exit_hook_registered) {
+        atexit(gcLogClose);
+        exit_hook_registered = 1;
+    }
+
+    atomic_store(&gc_log_running, 1);
+    if (thrd_create(&gc_log_writer, gcLogWriterMain, NULL) != thrd_success) {
+        fclose(gc_log_file);
+        gc_log_file = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+#endif // GC_EVENT_LOG_H
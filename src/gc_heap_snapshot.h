@@ -0,0 +1,47 @@
+/*
+GC Heap Snapshot Format (C17, header-only)
+
+Binary heap snapshot written by mark_and_sweep.exe --snapshot and read by
+heap_snapshot_analyzer.exe. Objects are numbered 0..object_count-1 in pool
+slot order. Every section is a flat little-endian array, so a reader can
+load each one with a single fread:
+
+    gc_snapshot_header_t header
+    uint32_t size[object_count]                 bytes the object occupies
+    uint32_t name[object_count]                 index into the string table
+    uint64_t edge_offset[object_count + 1]      CSR offsets into edge_target
+    uint32_t edge_target[edge_count]            referenced object ids
+    uint32_t root[root_count]                   object ids on the root stack
+    uint32_t parent[object_count]               previous hop on a shortest root
+                                                path (roots point at themselves,
+                                                GC_SNAPSHOT_NO_PARENT = unreachable)
+    uint64_t string_offset[string_count + 1]    offsets into string_data
+    char string_data[string_bytes]              names, not NUL-terminated
+
+Code Structure:
+Includes
+Constants & Macros
+Struct Definitions
+*/
+
+#ifndef GC_HEAP_SNAPSHOT_H
+#define GC_HEAP_SNAPSHOT_H
+
+//  Includes
+#include <stdint.h>
+
+//  Constants & Macros
+#define GC_SNAPSHOT_MAGIC "GCSNAP1"                     //  8 bytes with the terminator
+#define GC_SNAPSHOT_NO_PARENT UINT32_MAX
+
+//  Struct Definitions
+typedef struct GcSnapshotHeader {
+    char magic[8];
+    uint64_t object_count;
+    uint64_t edge_count;
+    uint64_t root_count;
+    uint64_t string_count;
+    uint64_t string_bytes;
+} gc_snapshot_header_t;
+
+#endif // GC_HEAP_SNAPSHOT_H
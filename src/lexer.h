@@ -0,0 +1,1180 @@
+/*
+Lexer (C17, header-only)
+
+The lexer core of lexical_analyzer.c, for any program that wants C tokens:
+source buffers (memory-mapped or block-read), the identifier intern table,
+the per-dialect perfect-hash keyword table, the DFA built from the token
+specification and the SSE2/AVX2 fast-path kernels.
+
+Tokens are produced one at a time, so memory stays constant whatever the
+input size and a consumer (a parser, a checker, a writer) sees each token
+as soon as it is lexed:
+    lexerSetup(DIALECT_CLASSIC, NULL);          once per process
+    lexer_t lexer;
+    token_t token;
+    lexerInit(&lexer, &source, &symbols);
+    while (lexerNext(&lexer, &token)) ...       pull one token per call
+or lexerRun(&source, &symbols, callback, context) to have each token pushed
+to a callback. Only the intern table grows, by one copy of each distinct
+identifier.
+
+Code Structure:
+Includes
+Constants & Macros
+Struct Definitions
+Global Variables
+Function Definitions
+*/
+
+#ifndef LEXER_H
+#define LEXER_H
+
+//  Includes
+//  mmap() and posix_madvise() are POSIX, not ISO C: ask for them explicitly.
+//  Programs that include system headers first must define this themselves.
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//  SSE2 is part of x86-64; AVX2 kernels are compiled for it and only called
+//  after a CPUID check
+#if defined(__x86_64__) || defined(_M_X64)
+#define LEX_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LEX_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define LEX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//  Constants & Macros
+#define INTERN_INITIAL_SLOTS 1024            //  Power of two; kept at most half full
+#define INTERN_TEXT_INITIAL_CAPACITY 4096
+#define SOURCE_READ_BLOCK (1 << 20)         //  Bytes per fread() when the file is not mapped
+#define KEYWORD_MAX_COUNT 128                //  Slots store 1 + index in an unsigned char
+#define KEYWORD_SEED_ATTEMPTS 4096           //  Seeds tried per table size before doubling it
+#define KEYWORD_MAX_SLOT_BITS 16
+#define LEX_MAX_STATES 256                   //  States are stored in a byte
+#define LEX_STATE_DEAD 0
+#define LEX_STATE_START 1
+#define LEX_ACCEPT_NONE 0
+#define LEX_ACCEPT_SKIP 1                    //  Blanks and line comments, never a newline
+#define LEX_ACCEPT_NEWLINE 2                 //  One newline, then blanks
+#define LEX_ACCEPT_SKIP_LINES 3              //  Block comments, which may span lines
+#define LEX_ACCEPT(kind) (4 + (kind))
+#define LEX_FAST_NONE 0
+#define LEX_FAST_BLANKS 1                    //  Stay in the state past [ \t\v\f\r]*
+#define LEX_FAST_LINE 2                      //  Stay in the state up to the next newline
+#define LEX_FAST_BLOCK 3                     //  Jump past the next "*/" into block_end
+#define LEX_FAST_IDENTIFIER 4                //  Stay in the state past [A-Za-z0-9_]*
+
+//  Struct Definitions
+//  Token Kinds
+typedef enum TokenKind {
+    TOKEN_KEYWORD,
+    TOKEN_IDENTIFIER,
+    TOKEN_NUMBER,
+    TOKEN_OPERATOR,
+    TOKEN_DELIMITER,
+    TOKEN_UNKNOWN,
+    TOKEN_STRING,
+    TOKEN_CHARACTER,
+    TOKEN_KIND_COUNT
+} token_kind_t;
+
+//  Token Structure: the text is source->data[offset, offset + length). An
+//  identifier stores its interned symbol instead; the symbol holds the length.
+typedef struct Token {
+    uint32_t offset;
+    union {
+        uint32_t length;
+        uint32_t symbol;                        //  TOKEN_IDENTIFIER: index in intern_table_t.symbols
+    };
+    uint32_t line;
+    uint16_t column;                            //  Saturates at UINT16_MAX
+    uint8_t kind;                               //  token_kind_t
+    uint8_t reserved;
+} token_t;
+
+_Static_assert(sizeof(token_t) == 16, "tokens must stay 16 bytes");
+
+//  Interned identifier: text[offset, offset + length) of the table's text pool
+typedef struct Symbol {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t hash;
+} symbol_t;
+
+//  Identifier intern table: open addressing over symbol ids, one copy of
+//  each distinct identifier in a shared text pool
+typedef struct InternTable {
+    symbol_t *symbols;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *slots;                            //  0 = empty, otherwise 1 + symbol id
+    uint32_t slot_mask;
+    char *text;
+    size_t text_length;
+    size_t text_capacity;
+} intern_table_t;
+
+//  Source Buffer: the whole input file as one byte span
+typedef struct SourceBuffer {
+    const char *data;
+    size_t length;
+    int mapped;                                 //  1: file mapping, 0: heap copy
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} source_buffer_t;
+
+//  Keyword Dialects (bit flags, so one table entry can serve several)
+typedef enum Dialect {
+    DIALECT_CLASSIC = 1 << 0,                   //  The original table: C99 minus _Bool/_Complex/_Imaginary, plus main
+    DIALECT_C89 = 1 << 1,
+    DIALECT_C99 = 1 << 2,
+    DIALECT_C11 = 1 << 3,                       //  Also C17
+    DIALECT_C23 = 1 << 4,
+    DIALECT_CPP = 1 << 5                        //  C++20
+} dialect_t;
+
+#define C89_UP (DIALECT_CLASSIC | DIALECT_C89 | DIALECT_C99 | DIALECT_C11 | DIALECT_C23)
+#define C99_UP (DIALECT_C99 | DIALECT_C11 | DIALECT_C23)
+#define C11_UP (DIALECT_C11 | DIALECT_C23)
+
+typedef struct KeywordSpec {
+    const char *text;
+    unsigned dialects;
+} keyword_spec_t;
+
+//  Perfect hash slot: 0 = empty, otherwise 1 + index into keyword_table.entries
+typedef struct KeywordEntry {
+    const char *text;
+    size_t length;
+} keyword_entry_t;
+
+typedef struct KeywordTable {
+    keyword_entry_t entries[KEYWORD_MAX_COUNT];
+    int count;
+    unsigned char *slots;
+    uint32_t seed;                              //  Odd multiplier that separates every keyword
+    int shift;                                  //  32 - log2(slot count)
+    size_t min_length;
+    size_t max_length;
+} keyword_table_t;
+
+//  Token specification: literal operators/punctuators, named states with
+//  what they accept, and transitions between them. A rule's from-state is a
+//  named state, "start", or a literal prefix written `text. Later rules
+//  override earlier ones; a byte set is a list of bytes and a-b ranges, a
+//  leading ^ negates it, and \ escapes the next byte.
+typedef struct LexLiteral {
+    const char *text;
+    token_kind_t kind;
+} lex_literal_t;
+
+typedef struct LexStateSpec {
+    const char *name;
+    int accept;                                 //  LEX_ACCEPT_*
+    int fast;                                   //  LEX_FAST_*, run on entering the state
+} lex_state_spec_t;
+
+typedef struct LexRule {
+    const char *from;
+    const char *bytes;
+    const char *to;
+} lex_rule_t;
+
+//  Built DFA. States are addressed by row, state * class_count, so a step
+//  is row = next[row + byte_class[byte]] with no multiply; row 0 is dead.
+typedef struct LexDfa {
+    uint8_t byte_class[256];
+    int class_count;
+    int state_count;
+    uint16_t *next;
+    uint8_t *accept;                            //  Indexed by row
+    uint8_t *fast;                              //  Indexed by row
+    uint16_t block_end_row;                     //  Where LEX_FAST_BLOCK lands
+} lex_dfa_t;
+
+//  Fast-path kernels; each returns the first byte in [p, end) that ends the
+//  run, or end. findCommentEnd() returns the '*' of the first "*/".
+typedef struct LexKernels {
+    const char *name;
+    const char *(*skipBlanks)(const char *p, const char *end);
+    const char *(*findNewline)(const char *p, const char *end);
+    const char *(*findCommentEnd)(const char *p, const char *end);
+    const char *(*skipIdentifier)(const char *p, const char *end);
+} lex_kernels_t;
+
+//  Pull lexer over one source buffer: lexerNext() resumes where the last
+//  token ended, so only one token is ever held
+typedef struct Lexer {
+    const char *base;
+    const char *p;
+    const char *end;
+    const char *line_start;
+    uint32_t line;
+    intern_table_t *symbols;
+} lexer_t;
+
+//  Called by lexerRun() for every token; return 0 to stop early
+typedef int (*lexer_callback_t)(const token_t *token, void *context);
+
+//  Keyword Table
+static const keyword_spec_t keyword_specs[] = {
+    { "auto", C89_UP | DIALECT_CPP }, { "break", C89_UP | DIALECT_CPP }, { "case", C89_UP | DIALECT_CPP },
+    { "char", C89_UP | DIALECT_CPP }, { "const", C89_UP | DIALECT_CPP }, { "continue", C89_UP | DIALECT_CPP },
+    { "default", C89_UP | DIALECT_CPP }, { "do", C89_UP | DIALECT_CPP }, { "double", C89_UP | DIALECT_CPP },
+    { "else", C89_UP | DIALECT_CPP }, { "enum", C89_UP | DIALECT_CPP }, { "extern", C89_UP | DIALECT_CPP },
+    { "float", C89_UP | DIALECT_CPP }, { "for", C89_UP | DIALECT_CPP }, { "goto", C89_UP | DIALECT_CPP },
+    { "if", C89_UP | DIALECT_CPP }, { "int", C89_UP | DIALECT_CPP }, { "long", C89_UP | DIALECT_CPP },
+    { "register", C89_UP | DIALECT_CPP }, { "return", C89_UP | DIALECT_CPP }, { "short", C89_UP | DIALECT_CPP },
+    { "signed", C89_UP | DIALECT_CPP }, { "sizeof", C89_UP | DIALECT_CPP }, { "static", C89_UP | DIALECT_CPP },
+    { "struct", C89_UP | DIALECT_CPP }, { "switch", C89_UP | DIALECT_CPP }, { "typedef", C89_UP | DIALECT_CPP },
+    { "union", C89_UP | DIALECT_CPP }, { "unsigned", C89_UP | DIALECT_CPP }, { "void", C89_UP | DIALECT_CPP },
+    { "volatile", C89_UP | DIALECT_CPP }, { "while", C89_UP | DIALECT_CPP },
+    { "inline", DIALECT_CLASSIC | C99_UP | DIALECT_CPP }, { "restrict", DIALECT_CLASSIC | C99_UP },
+    { "main", DIALECT_CLASSIC },
+    { "_Bool", C99_UP }, { "_Complex", C99_UP }, { "_Imaginary", C99_UP },
+    { "_Alignas", C11_UP }, { "_Alignof", C11_UP }, { "_Atomic", C11_UP }, { "_Generic", C11_UP },
+    { "_Noreturn", C11_UP }, { "_Static_assert", C11_UP }, { "_Thread_local", C11_UP },
+    { "alignas", DIALECT_C23 | DIALECT_CPP }, { "alignof", DIALECT_C23 | DIALECT_CPP },
+    { "bool", DIALECT_C23 | DIALECT_CPP }, { "constexpr", DIALECT_C23 | DIALECT_CPP },
+    { "false", DIALECT_C23 | DIALECT_CPP }, { "nullptr", DIALECT_C23 | DIALECT_CPP },
+    { "static_assert", DIALECT_C23 | DIALECT_CPP }, { "thread_local", DIALECT_C23 | DIALECT_CPP },
+    { "true", DIALECT_C23 | DIALECT_CPP }, { "typeof", DIALECT_C23 }, { "typeof_unqual", DIALECT_C23 },
+    { "_BitInt", DIALECT_C23 }, { "_Decimal32", DIALECT_C23 }, { "_Decimal64", DIALECT_C23 },
+    { "_Decimal128", DIALECT_C23 },
+    { "and", DIALECT_CPP }, { "and_eq", DIALECT_CPP }, { "asm", DIALECT_CPP }, { "bitand", DIALECT_CPP },
+    { "bitor", DIALECT_CPP }, { "catch", DIALECT_CPP }, { "char8_t", DIALECT_CPP }, { "char16_t", DIALECT_CPP },
+    { "char32_t", DIALECT_CPP }, { "class", DIALECT_CPP }, { "compl", DIALECT_CPP }, { "concept", DIALECT_CPP },
+    { "consteval", DIALECT_CPP }, { "constinit", DIALECT_CPP }, { "const_cast", DIALECT_CPP },
+    { "co_await", DIALECT_CPP }, { "co_return", DIALECT_CPP }, { "co_yield", DIALECT_CPP },
+    { "decltype", DIALECT_CPP }, { "delete", DIALECT_CPP }, { "dynamic_cast", DIALECT_CPP },
+    { "explicit", DIALECT_CPP }, { "export", DIALECT_CPP }, { "friend", DIALECT_CPP }, { "mutable", DIALECT_CPP },
+    { "namespace", DIALECT_CPP }, { "new", DIALECT_CPP }, { "noexcept", DIALECT_CPP }, { "not", DIALECT_CPP },
+    { "not_eq", DIALECT_CPP }, { "operator", DIALECT_CPP }, { "or", DIALECT_CPP }, { "or_eq", DIALECT_CPP },
+    { "private", DIALECT_CPP }, { "protected", DIALECT_CPP }, { "public", DIALECT_CPP },
+    { "reinterpret_cast", DIALECT_CPP }, { "requires", DIALECT_CPP }, { "static_cast", DIALECT_CPP },
+    { "template", DIALECT_CPP }, { "this", DIALECT_CPP }, { "throw", DIALECT_CPP }, { "try", DIALECT_CPP },
+    { "typeid", DIALECT_CPP }, { "typename", DIALECT_CPP }, { "using", DIALECT_CPP }, { "virtual", DIALECT_CPP },
+    { "wchar_t", DIALECT_CPP }, { "xor", DIALECT_CPP }, { "xor_eq", DIALECT_CPP }
+};
+static const int keyword_spec_count = sizeof(keyword_specs) / sizeof(keyword_specs[0]);
+
+static const struct { const char *name; dialect_t dialect; } dialect_names[] = {
+    { "classic", DIALECT_CLASSIC }, { "c89", DIALECT_C89 }, { "c99", DIALECT_C99 },
+    { "c11", DIALECT_C11 }, { "c17", DIALECT_C11 }, { "c23", DIALECT_C23 }, { "cpp", DIALECT_CPP }
+};
+
+//  Token Specification
+static const lex_literal_t lex_literals[] = {
+    { "(", TOKEN_DELIMITER }, { ")", TOKEN_DELIMITER }, { "{", TOKEN_DELIMITER }, { "}", TOKEN_DELIMITER },
+    { "[", TOKEN_DELIMITER }, { "]", TOKEN_DELIMITER }, { ";", TOKEN_DELIMITER }, { ":", TOKEN_DELIMITER },
+    { ",", TOKEN_DELIMITER }, { ".", TOKEN_DELIMITER }, { "...", TOKEN_DELIMITER },
+    { "+", TOKEN_OPERATOR }, { "-", TOKEN_OPERATOR }, { "*", TOKEN_OPERATOR }, { "/", TOKEN_OPERATOR },
+    { "%", TOKEN_OPERATOR }, { "=", TOKEN_OPERATOR }, { "<", TOKEN_OPERATOR }, { ">", TOKEN_OPERATOR },
+    { "!", TOKEN_OPERATOR }, { "~", TOKEN_OPERATOR }, { "&", TOKEN_OPERATOR }, { "|", TOKEN_OPERATOR },
+    { "^", TOKEN_OPERATOR }, { "?", TOKEN_OPERATOR }, { "#", TOKEN_OPERATOR }, { "##", TOKEN_OPERATOR },
+    { "->", TOKEN_OPERATOR }, { "++", TOKEN_OPERATOR }, { "--", TOKEN_OPERATOR }, { "<<", TOKEN_OPERATOR },
+    { ">>", TOKEN_OPERATOR }, { "<=", TOKEN_OPERATOR }, { ">=", TOKEN_OPERATOR }, { "==", TOKEN_OPERATOR },
+    { "!=", TOKEN_OPERATOR }, { "&&", TOKEN_OPERATOR }, { "||", TOKEN_OPERATOR }, { "+=", TOKEN_OPERATOR },
+    { "-=", TOKEN_OPERATOR }, { "*=", TOKEN_OPERATOR }, { "/=", TOKEN_OPERATOR }, { "%=", TOKEN_OPERATOR },
+    { "&=", TOKEN_OPERATOR }, { "|=", TOKEN_OPERATOR }, { "^=", TOKEN_OPERATOR }, { "<<=", TOKEN_OPERATOR },
+    { ">>=", TOKEN_OPERATOR }
+};
+
+static const lex_state_spec_t lex_state_specs[] = {
+    { "identifier", LEX_ACCEPT(TOKEN_IDENTIFIER), LEX_FAST_IDENTIFIER },
+    { "space", LEX_ACCEPT_SKIP, LEX_FAST_BLANKS },
+    { "newline", LEX_ACCEPT_NEWLINE, LEX_FAST_BLANKS },
+    { "line_comment", LEX_ACCEPT_SKIP, LEX_FAST_LINE },
+    { "block_comment", LEX_ACCEPT_SKIP_LINES, LEX_FAST_BLOCK },     //  Accepting, so an unterminated comment runs to the end
+    { "block_star", LEX_ACCEPT_SKIP_LINES, LEX_FAST_NONE },
+    { "block_end", LEX_ACCEPT_SKIP_LINES, LEX_FAST_NONE },
+    { "decimal", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "zero", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "fraction", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "exponent_mark", LEX_ACCEPT_NONE, LEX_FAST_NONE },
+    { "exponent_sign", LEX_ACCEPT_NONE, LEX_FAST_NONE },
+    { "exponent", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "hex_mark", LEX_ACCEPT_NONE, LEX_FAST_NONE },
+    { "hex", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "hex_point", LEX_ACCEPT_NONE, LEX_FAST_NONE },
+    { "hex_fraction", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "integer_suffix", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    { "float_suffix", LEX_ACCEPT(TOKEN_NUMBER), LEX_FAST_NONE },
+    //  An unterminated literal is one UNKNOWN token up to its newline, so its
+    //  bytes are never scanned again from the next start position
+    { "string", LEX_ACCEPT(TOKEN_UNKNOWN), LEX_FAST_NONE },
+    { "string_escape", LEX_ACCEPT(TOKEN_UNKNOWN), LEX_FAST_NONE },
+    { "string_end", LEX_ACCEPT(TOKEN_STRING), LEX_FAST_NONE },
+    { "character", LEX_ACCEPT(TOKEN_UNKNOWN), LEX_FAST_NONE },
+    { "character_escape", LEX_ACCEPT(TOKEN_UNKNOWN), LEX_FAST_NONE },
+    { "character_end", LEX_ACCEPT(TOKEN_CHARACTER), LEX_FAST_NONE }
+};
+
+static const lex_rule_t lex_rules[] = {
+    { "start", "A-Za-z_", "identifier" },
+    { "identifier", "A-Za-z0-9_", "identifier" },
+    { "start", " \t\v\f\r", "space" },
+    { "space", " \t\v\f\r", "space" },
+    { "start", "\n", "newline" },
+    { "newline", " \t\v\f\r", "newline" },
+    { "`/", "/", "line_comment" },
+    { "line_comment", "^\n", "line_comment" },
+    { "`/", "*", "block_comment" },
+    { "block_comment", "^*", "block_comment" },
+    { "block_comment", "*", "block_star" },
+    { "block_star", "^*/", "block_comment" },
+    { "block_star", "*", "block_star" },
+    { "block_star", "/", "block_end" },
+    { "start", "1-9", "decimal" },
+    { "start", "0", "zero" },
+    { "decimal", "0-9", "decimal" },
+    { "decimal", ".", "fraction" },
+    { "decimal", "eE", "exponent_mark" },
+    { "decimal", "uUlL", "integer_suffix" },
+    { "zero", "0-9", "decimal" },
+    { "zero", ".", "fraction" },
+    { "zero", "eE", "exponent_mark" },
+    { "zero", "xX", "hex_mark" },
+    { "zero", "uUlL", "integer_suffix" },
+    { "`.", "0-9", "fraction" },
+    { "fraction", "0-9", "fraction" },
+    { "fraction", "eE", "exponent_mark" },
+    { "fraction", "fFlL", "float_suffix" },
+    { "exponent_mark", "+-", "exponent_sign" },
+    { "exponent_mark", "0-9", "exponent" },
+    { "exponent_sign", "0-9", "exponent" },
+    { "exponent", "0-9", "exponent" },
+    { "exponent", "fFlL", "float_suffix" },
+    { "hex_mark", "0-9a-fA-F", "hex" },
+    { "hex", "0-9a-fA-F", "hex" },
+    { "hex", "pP", "exponent_mark" },
+    { "hex", ".", "hex_fraction" },
+    { "hex_mark", ".", "hex_point" },
+    { "hex_point", "0-9a-fA-F", "hex_fraction" },
+    { "hex_fraction", "0-9a-fA-F", "hex_fraction" },
+    { "hex_fraction", "pP", "exponent_mark" },
+    { "hex", "uUlL", "integer_suffix" },
+    { "integer_suffix", "uUlL", "integer_suffix" },
+    { "start", "\"", "string" },
+    { "string", "^\"\\\n", "string" },
+    { "string", "\\", "string_escape" },
+    { "string_escape", "^", "string" },
+    { "string", "\"", "string_end" },
+    { "start", "'", "character" },
+    { "character", "^'\\\n", "character" },
+    { "character", "\\", "character_escape" },
+    { "character_escape", "^", "character" },
+    { "character", "'", "character_end" }
+};
+
+//  Global Variables
+static keyword_table_t keyword_table;
+static lex_dfa_t lex_dfa;
+static const lex_kernels_t *lex_kernels;
+static const char *const token_kind_names[TOKEN_KIND_COUNT] = {
+    "KEYWORD", "IDENTIFIER", "NUMBER", "OPERATOR", "DELIMITER", "UNKNOWN", "STRING", "CHARACTER"
+};
+
+//  Function Definitions
+static inline int parseDialect(const char *name, dialect_t *dialect) {
+    for (size_t i = 0; i < sizeof(dialect_names) / sizeof(dialect_names[0]); ++i) {
+        if (strcmp(name, dialect_names[i].name) == 0) {
+            *dialect = dialect_names[i].dialect;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//  Key: length, first, middle and last character, which are distinct for
+//  every keyword of every dialect. Multiply-shift maps it to a slot.
+static inline uint32_t keywordHash(const char *word, size_t length, uint32_t seed, int shift) {
+    uint32_t key = (uint32_t)length
+                 | (uint32_t)(unsigned char)word[0] << 8
+                 | (uint32_t)(unsigned char)word[length / 2] << 16
+                 | (uint32_t)(unsigned char)word[length - 1] << 24;
+    return (key * seed) >> shift;
+}
+
+//  Collect the dialect's keywords and search for a multiplier under which no
+//  two of them share a slot, doubling the slot count whenever
+//  KEYWORD_SEED_ATTEMPTS seeds fail. Runs once, before lexing starts.
+static inline void buildKeywordTable(dialect_t dialect) {
+    keyword_table_t *table = &keyword_table;
+    free(table->slots);
+    memset(table, 0, sizeof(*table));
+    table->min_length = SIZE_MAX;
+    for (int i = 0; i < keyword_spec_count; ++i) {
+        if (!(keyword_specs[i].dialects & dialect)) continue;
+        keyword_entry_t *entry = &table->entries[table->count++];
+        entry->text = keyword_specs[i].text;
+        entry->length = strlen(entry->text);
+        if (entry->length < table->min_length) table->min_length = entry->length;
+        if (entry->length > table->max_length) table->max_length = entry->length;
+    }
+
+    int bits = 1;
+    while ((1 << bits) < table->count * 4) bits++;
+    uint64_t random_state = 0x9E3779B97F4A7C15ULL;      //  Fixed, so every run builds the same table
+    for (; bits <= KEYWORD_MAX_SLOT_BITS; bits++) {
+        size_t slot_count = (size_t)1 << bits;
+        table->slots = realloc(table->slots, slot_count);
+        if (!table->slots) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        table->shift = 32 - bits;
+        for (int attempt = 0; attempt < KEYWORD_SEED_ATTEMPTS; attempt++) {
+            random_state ^= random_state << 13;
+            random_state ^= random_state >> 7;
+            random_state ^= random_state << 17;
+            table->seed = (uint32_t)random_state | 1;
+            memset(table->slots, 0, slot_count);
+            int placed = 0;
+            while (placed < table->count) {
+                keyword_entry_t *entry = &table->entries[placed];
+                uint32_t slot = keywordHash(entry->text, entry->length, table->seed, table->shift);
+                if (table->slots[slot]) break;
+                table->slots[slot] = (unsigned char)(placed + 1);
+                placed++;
+            }
+            if (placed == table->count) return;
+        }
+    }
+    fprintf(stderr, "ERROR: No perfect hash found for the keyword table.\n");
+    exit(EXIT_FAILURE);
+}
+
+//  Check if word[0..length) is a keyword: one slot probe and one memcmp
+static inline int isKeyword(const char *word, size_t length) {
+    const keyword_table_t *table = &keyword_table;
+    if (length < table->min_length || length > table->max_length) return 0;
+    unsigned slot = table->slots[keywordHash(word, length, table->seed, table->shift)];
+    if (!slot) return 0;
+    const keyword_entry_t *entry = &table->entries[slot - 1];
+    return entry->length == length && memcmp(word, entry->text, length) == 0;
+}
+
+static inline void initInternTable(intern_table_t *table) {
+    memset(table, 0, sizeof(*table));
+    table->slots = calloc(INTERN_INITIAL_SLOTS, sizeof(*table->slots));
+    if (!table->slots) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    table->slot_mask = INTERN_INITIAL_SLOTS - 1;
+}
+
+//  Multiply-xorshift over 8-byte words: one multiply per word instead of
+//  FNV-1a's one per byte. Never reads outside text[0..length).
+static inline uint32_t internHash(const char *text, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15u ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, text + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDu;
+        hash ^= hash >> 32;
+    }
+    if (i < length) {
+        uint64_t word = 0;
+        memcpy(&word, text + i, length - i);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDu;
+        hash ^= hash >> 32;
+    }
+    return (uint32_t)hash;
+}
+
+//  Return the symbol id of text[0..length), adding it on first sight
+static inline uint32_t internIdentifier(intern_table_t *table, const char *text, size_t length) {
+    uint32_t hash = internHash(text, length);
+
+    uint32_t slot = hash & table->slot_mask;
+    while (table->slots[slot]) {
+        const symbol_t *symbol = &table->symbols[table->slots[slot] - 1];
+        if (symbol->hash == hash && symbol->length == length && memcmp(table->text + symbol->offset, text, length) == 0)
+            return table->slots[slot] - 1;
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    if (table->count == table->capacity) {
+        uint32_t new_capacity = table->capacity ? table->capacity * 2 : INTERN_INITIAL_SLOTS / 2;
+        symbol_t *symbols = realloc(table->symbols, new_capacity * sizeof(*symbols));
+        if (!symbols) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        table->symbols = symbols;
+        table->capacity = new_capacity;
+    }
+    if (table->text_capacity - table->text_length < length) {
+        size_t new_capacity = table->text_capacity ? table->text_capacity : INTERN_TEXT_INITIAL_CAPACITY;
+        while (new_capacity - table->text_length < length) new_capacity *= 2;
+        char *pool = realloc(table->text, new_capacity);
+        if (!pool) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        table->text = pool;
+        table->text_capacity = new_capacity;
+    }
+
+    uint32_t id = table->count++;
+    symbol_t *symbol = &table->symbols[id];
+    symbol->offset = (uint32_t)table->text_length;
+    symbol->length = (uint32_t)length;
+    symbol->hash = hash;
+    memcpy(table->text + table->text_length, text, length);
+    table->text_length += length;
+    table->slots[slot] = id + 1;
+
+    //  Keep the table at most half full: rehash every symbol into twice the slots
+    if ((size_t)table->count * 2 > (size_t)table->slot_mask + 1) {
+        uint32_t new_mask = table->slot_mask * 2 + 1;
+        uint32_t *slots = calloc((size_t)new_mask + 1, sizeof(*slots));
+        if (!slots) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t i = 0; i < table->count; ++i) {
+            uint32_t s = table->symbols[i].hash & new_mask;
+            while (slots[s]) s = (s + 1) & new_mask;
+            slots[s] = i + 1;
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->slot_mask = new_mask;
+    }
+    return id;
+}
+
+static inline void freeInternTable(intern_table_t *table) {
+    free(table->symbols);
+    free(table->slots);
+    free(table->text);
+    memset(table, 0, sizeof(*table));
+}
+
+//  Text of any token: identifiers come from the intern table, the rest from
+//  the source buffer
+static inline const char *tokenText(const source_buffer_t *source, const intern_table_t *symbols,
+                                    const token_t *token, size_t *length) {
+    if (token->kind == TOKEN_IDENTIFIER) {
+        const symbol_t *symbol = &symbols->symbols[token->symbol];
+        *length = symbol->length;
+        return symbols->text + symbol->offset;
+    }
+    *length = token->length;
+    return source->data + token->offset;
+}
+
+//  Read the file into a heap buffer SOURCE_READ_BLOCK bytes per fread()
+static inline int readSourceBlocks(const char *filename, source_buffer_t *source) {
+    FILE *in = NULL;
+    errno_t err = fopen_s(&in, filename, "rb");
+    if (err != 0 || !in) return 0;
+
+    char *data = NULL;
+    size_t length = 0, capacity = 0;
+    while (1) {
+        if (capacity - length < SOURCE_READ_BLOCK) {
+            capacity = capacity ? capacity * 2 : SOURCE_READ_BLOCK;
+            char *grown = realloc(data, capacity);
+            if (!grown) {
+                fprintf(stderr, "ERROR: Memory allocation failed.\n");
+                exit(EXIT_FAILURE);
+            }
+            data = grown;
+        }
+        size_t got = fread(data + length, 1, SOURCE_READ_BLOCK, in);
+        length += got;
+        if (got < SOURCE_READ_BLOCK) break;
+    }
+    fclose(in);
+
+    source->data = data;
+    source->length = length;
+    source->mapped = 0;
+    return 1;
+}
+
+//  Map the whole file read-only; fall back to block reads if mapping is not
+//  allowed or fails. Returns 1 on success.
+static inline int openSource(const char *filename, int allow_map, source_buffer_t *source) {
+    memset(source, 0, sizeof(*source));
+    if (!allow_map) return readSourceBlocks(filename, source);
+
+#if defined(_WIN32)
+    source->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (source->file == INVALID_HANDLE_VALUE) return readSourceBlocks(filename, source);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(source->file, &size) || size.QuadPart == 0) {
+        CloseHandle(source->file);
+        return readSourceBlocks(filename, source);      //  Empty files cannot be mapped
+    }
+    source->mapping = CreateFileMappingA(source->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const char *view = source->mapping ? MapViewOfFile(source->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!view) {
+        if (source->mapping) CloseHandle(source->mapping);
+        CloseHandle(source->file);
+        return readSourceBlocks(filename, source);
+    }
+    source->data = view;
+    source->length = (size_t)size.QuadPart;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return readSourceBlocks(filename, source);
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        close(fd);
+        return readSourceBlocks(filename, source);      //  Pipes and empty files cannot be mapped
+    }
+    void *view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);                                          //  The mapping keeps the file open
+    if (view == MAP_FAILED) return readSourceBlocks(filename, source);
+    posix_madvise(view, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+    source->data = view;
+    source->length = (size_t)info.st_size;
+#endif
+    source->mapped = 1;
+    return 1;
+}
+
+static inline void closeSource(source_buffer_t *source) {
+    if (source->mapped) {
+#if defined(_WIN32)
+        UnmapViewOfFile(source->data);
+        CloseHandle(source->mapping);
+        CloseHandle(source->file);
+#else
+        munmap((void *)source->data, source->length);
+#endif
+    } else {
+        free((void *)source->data);
+    }
+    memset(source, 0, sizeof(*source));
+}
+
+//  Parse a rule's byte set into set[256]
+static inline void parseByteSet(const char *spec, unsigned char set[256]) {
+    int negate = *spec == '^';
+    if (negate) spec++;
+    memset(set, 0, 256);
+    while (*spec) {
+        unsigned char low = (unsigned char)*spec++;
+        if (low == '\\' && *spec) {
+            low = (unsigned char)*spec++;
+            if (low == 'n') low = '\n';
+            else if (low == 't') low = '\t';
+            else if (low == 'v') low = '\v';
+            else if (low == 'f') low = '\f';
+            else if (low == 'r') low = '\r';
+        }
+        unsigned char high = low;
+        if (spec[0] == '-' && spec[1]) {
+            high = (unsigned char)spec[1];
+            spec += 2;
+        }
+        for (int b = low; b <= high; ++b) set[b] = 1;
+    }
+    if (negate) {
+        for (int b = 0; b < 256; ++b) set[b] = !set[b];
+    }
+}
+
+//  State id of a rule endpoint: "start", a named state, or `literal (the trie
+//  state reached by the literal's bytes)
+static inline int findLexState(uint8_t (*full)[256], const char *name) {
+    if (strcmp(name, "start") == 0) return LEX_STATE_START;
+    if (name[0] == '`') {
+        int state = LEX_STATE_START;
+        for (const char *c = name + 1; *c && state != LEX_STATE_DEAD; ++c) state = full[state][(unsigned char)*c];
+        if (state != LEX_STATE_DEAD) return state;
+    } else {
+        int count = (int)(sizeof(lex_state_specs) / sizeof(lex_state_specs[0]));
+        for (int i = 0; i < count; ++i) {
+            if (strcmp(name, lex_state_specs[i].name) == 0) return 2 + i;
+        }
+    }
+    fprintf(stderr, "ERROR: Token specification names unknown state '%s'.\n", name);
+    exit(EXIT_FAILURE);
+}
+
+//  Build lex_dfa from the token specification: named states first, then the
+//  literal trie, then the rules; finally merge bytes whose columns are equal
+//  into classes. Runs once, before lexing starts.
+static inline void buildLexDfa(void) {
+    lex_dfa_t *dfa = &lex_dfa;
+    uint8_t (*full)[256] = calloc(LEX_MAX_STATES, sizeof(*full));
+    if (!full) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    uint8_t accept[LEX_MAX_STATES] = { LEX_ACCEPT_NONE };
+    uint8_t fast[LEX_MAX_STATES] = { LEX_FAST_NONE };
+
+    int state_spec_count = (int)(sizeof(lex_state_specs) / sizeof(lex_state_specs[0]));
+    int state_count = 2 + state_spec_count;
+    for (int i = 0; i < state_spec_count; ++i) {
+        accept[2 + i] = (uint8_t)lex_state_specs[i].accept;
+        fast[2 + i] = (uint8_t)lex_state_specs[i].fast;
+    }
+
+    for (size_t i = 0; i < sizeof(lex_literals) / sizeof(lex_literals[0]); ++i) {
+        int state = LEX_STATE_START;
+        for (const char *c = lex_literals[i].text; *c; ++c) {
+            uint8_t *next = &full[state][(unsigned char)*c];
+            if (*next == LEX_STATE_DEAD) {
+                if (state_count == LEX_MAX_STATES) {
+                    fprintf(stderr, "ERROR: Token specification needs more than %d states.\n", LEX_MAX_STATES);
+                    exit(EXIT_FAILURE);
+                }
+                *next = (uint8_t)state_count++;
+            }
+            state = *next;
+        }
+        accept[state] = (uint8_t)LEX_ACCEPT(lex_literals[i].kind);
+    }
+
+    for (size_t i = 0; i < sizeof(lex_rules) / sizeof(lex_rules[0]); ++i) {
+        unsigned char set[256];
+        parseByteSet(lex_rules[i].bytes, set);
+        int from = findLexState(full, lex_rules[i].from);
+        int to = findLexState(full, lex_rules[i].to);
+        for (int b = 0; b < 256; ++b) {
+            if (set[b]) full[from][b] = (uint8_t)to;
+        }
+    }
+
+    //  A byte joins the first earlier byte whose column is identical
+    int representative[256];
+    dfa->class_count = 0;
+    for (int b = 0; b < 256; ++b) {
+        int match = -1;
+        for (int c = 0; c < dfa->class_count && match < 0; ++c) {
+            int same = 1;
+            for (int s = 0; s < state_count && same; ++s) same = full[s][b] == full[s][representative[c]];
+            if (same) match = c;
+        }
+        if (match < 0) {
+            match = dfa->class_count++;
+            representative[match] = b;
+        }
+        dfa->byte_class[b] = (uint8_t)match;
+    }
+
+    free(dfa->next);
+    free(dfa->accept);
+    free(dfa->fast);
+    size_t cells = (size_t)state_count * (size_t)dfa->class_count;
+    dfa->state_count = state_count;
+    dfa->next = malloc(cells * sizeof(*dfa->next));
+    dfa->accept = calloc(cells, sizeof(*dfa->accept));
+    dfa->fast = calloc(cells, sizeof(*dfa->fast));
+    if (!dfa->next || !dfa->accept || !dfa->fast) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int s = 0; s < state_count; ++s) {
+        for (int c = 0; c < dfa->class_count; ++c)
+            dfa->next[s * dfa->class_count + c] = (uint16_t)(full[s][representative[c]] * dfa->class_count);
+        dfa->accept[s * dfa->class_count] = accept[s];
+        dfa->fast[s * dfa->class_count] = fast[s];
+    }
+    dfa->block_end_row = (uint16_t)(findLexState(full, "block_end") * dfa->class_count);
+    free(full);
+}
+
+//  Utility Function: index of the lowest set bit (mask must be non-zero)
+static inline unsigned lowestSetBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    unsigned index = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+static inline int isBlank(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline int isIdentifierByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+//  Scalar Kernels
+static inline const char *skipBlanksScalar(const char *p, const char *end) {
+    while (p < end && isBlank((unsigned char)*p)) p++;
+    return p;
+}
+
+static inline const char *findNewlineScalar(const char *p, const char *end) {
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return newline ? newline : end;
+}
+
+static inline const char *findCommentEndScalar(const char *p, const char *end) {
+    while (p + 1 < end) {
+        const char *star = memchr(p, '*', (size_t)(end - p - 1));
+        if (!star) return end;
+        if (star[1] == '/') return star;
+        p = star + 1;
+    }
+    return end;
+}
+
+static inline const char *skipIdentifierScalar(const char *p, const char *end) {
+    while (p < end && isIdentifierByte((unsigned char)*p)) p++;
+    return p;
+}
+
+#if defined(LEX_SIMD_X86)
+//  SSE2 Kernels: classify 16 bytes per compare, finish the tail with the
+//  scalar kernel. Bytes >= 0x80 are negative as signed chars, so the signed
+//  range compares below reject them.
+static inline const char *skipBlanksSse2(const char *p, const char *end) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i below_tab = _mm_set1_epi8('\t' - 1);
+    const __m128i above_cr = _mm_set1_epi8('\r' + 1);
+    const __m128i newline = _mm_set1_epi8('\n');
+    if (p < end && !isBlank((unsigned char)*p)) return p;  //  Most runs are a single blank
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(bytes, below_tab), _mm_cmplt_epi8(bytes, above_cr));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_andnot_si128(_mm_cmpeq_epi8(bytes, newline), control));
+        uint32_t stop = ~(uint32_t)_mm_movemask_epi8(blank) & 0xFFFF;
+        if (stop) return p + lowestSetBit(stop);
+        p += 16;
+    }
+    return skipBlanksScalar(p, end);
+}
+
+static inline const char *findNewlineSse2(const char *p, const char *end) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        uint32_t hit = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), newline));
+        if (hit) return p + lowestSetBit(hit);
+        p += 16;
+    }
+    return findNewlineScalar(p, end);
+}
+
+//  A '*' at byte i and a '/' at byte i + 1: compare p and p + 1
+static inline const char *findCommentEndSse2(const char *p, const char *end) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    while (end - p >= 17) {
+        __m128i stars = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), star);
+        __m128i slashes = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 1)), slash);
+        uint32_t hit = (uint32_t)_mm_movemask_epi8(_mm_and_si128(stars, slashes));
+        if (hit) return p + lowestSetBit(hit);
+        p += 16;
+    }
+    return findCommentEndScalar(p, end);
+}
+
+//  Letters are folded to lower case with | 0x20 before the range compare
+static inline const char *skipIdentifierSse2(const char *p, const char *end) {
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i below_a = _mm_set1_epi8('a' - 1);
+    const __m128i above_z = _mm_set1_epi8('z' + 1);
+    const __m128i below_0 = _mm_set1_epi8('0' - 1);
+    const __m128i above_9 = _mm_set1_epi8('9' + 1);
+    const __m128i underscore = _mm_set1_epi8('_');
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+        __m128i lower = _mm_or_si128(bytes, case_bit);
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, below_a), _mm_cmplt_epi8(lower, above_z));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, below_0), _mm_cmplt_epi8(bytes, above_9));
+        __m128i word = _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmpeq_epi8(bytes, underscore));
+        uint32_t stop = ~(uint32_t)_mm_movemask_epi8(word) & 0xFFFF;
+        if (stop) return p + lowestSetBit(stop);
+        p += 16;
+    }
+    return skipIdentifierScalar(p, end);
+}
+
+//  AVX2 Kernels: the SSE2 kernels on 32 bytes, finished by the SSE2 kernel
+LEX_TARGET_AVX2 static inline const char *skipBlanksAvx2(const char *p, const char *end) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i below_tab = _mm256_set1_epi8('\t' - 1);
+    const __m256i above_cr = _mm256_set1_epi8('\r' + 1);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    if (p < end && !isBlank((unsigned char)*p)) return p;
+    while (end - p >= 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)p);
+        __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, below_tab), _mm256_cmpgt_epi8(above_cr, bytes));
+        __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space),
+                                        _mm256_andnot_si256(_mm256_cmpeq_epi8(bytes, newline), control));
+        uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(blank);
+        if (stop) return p + lowestSetBit(stop);
+        p += 32;
+    }
+    return skipBlanksSse2(p, end);
+}
+
+LEX_TARGET_AVX2 static inline const char *findNewlineAvx2(const char *p, const char *end) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        uint32_t hit = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), newline));
+        if (hit) return p + lowestSetBit(hit);
+        p += 32;
+    }
+    return findNewlineSse2(p, end);
+}
+
+LEX_TARGET_AVX2 static inline const char *findCommentEndAvx2(const char *p, const char *end) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    while (end - p >= 33) {
+        __m256i stars = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)p), star);
+        __m256i slashes = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + 1)), slash);
+        uint32_t hit = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(stars, slashes));
+        if (hit) return p + lowestSetBit(hit);
+        p += 32;
+    }
+    return findCommentEndSse2(p, end);
+}
+
+LEX_TARGET_AVX2 static inline const char *skipIdentifierAvx2(const char *p, const char *end) {
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    const __m256i below_a = _mm256_set1_epi8('a' - 1);
+    const __m256i above_z = _mm256_set1_epi8('z' + 1);
+    const __m256i below_0 = _mm256_set1_epi8('0' - 1);
+    const __m256i above_9 = _mm256_set1_epi8('9' + 1);
+    const __m256i underscore = _mm256_set1_epi8('_');
+    while (end - p >= 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)p);
+        __m256i lower = _mm256_or_si256(bytes, case_bit);
+        __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, below_a), _mm256_cmpgt_epi8(above_z, lower));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, below_0), _mm256_cmpgt_epi8(above_9, bytes));
+        __m256i word = _mm256_or_si256(_mm256_or_si256(letter, digit), _mm256_cmpeq_epi8(bytes, underscore));
+        uint32_t stop = ~(uint32_t)_mm256_movemask_epi8(word);
+        if (stop) return p + lowestSetBit(stop);
+        p += 32;
+    }
+    return skipIdentifierSse2(p, end);
+}
+
+//  AVX2 needs the CPUID feature bit and the OS saving YMM state (XCR0 bits 1-2)
+static inline int cpuHasAvx2(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return 0;
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) return 0;
+    unsigned xcr0_low, xcr0_high;
+    __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    if ((xcr0_low & 6) != 6) return 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return 0;
+    return (ebx & bit_AVX2) != 0;
+#endif
+}
+#endif
+
+static const lex_kernels_t lex_kernel_sets[] = {
+    { "scalar", skipBlanksScalar, findNewlineScalar, findCommentEndScalar, skipIdentifierScalar },
+#if defined(LEX_SIMD_X86)
+    { "sse2", skipBlanksSse2, findNewlineSse2, findCommentEndSse2, skipIdentifierSse2 },
+    { "avx2", skipBlanksAvx2, findNewlineAvx2, findCommentEndAvx2, skipIdentifierAvx2 },
+#endif
+};
+static const int lex_kernel_set_count = sizeof(lex_kernel_sets) / sizeof(lex_kernel_sets[0]);
+
+//  Pick the named kernel set, or the widest one the CPU runs when name is
+//  NULL. Returns 0 if the named set is unknown or unsupported.
+static inline int selectLexKernels(const char *name) {
+    int usable = 1;
+#if defined(LEX_SIMD_X86)
+    usable = cpuHasAvx2() ? 3 : 2;
+#endif
+    if (!name) {
+        lex_kernels = &lex_kernel_sets[usable - 1];
+        return 1;
+    }
+    for (int i = 0; i < usable; ++i) {
+        if (strcmp(name, lex_kernel_sets[i].name) == 0) {
+            lex_kernels = &lex_kernel_sets[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//  Build the keyword table and the DFA, and select the kernels (NULL: the
+//  widest set the CPU runs). Call once, before lexing; returns 0 if the
+//  kernels are unknown or unsupported.
+static inline int lexerSetup(dialect_t dialect, const char *kernels) {
+    buildKeywordTable(dialect);
+    buildLexDfa();
+    return selectLexKernels(kernels);
+}
+
+//  Start lexing source; identifiers are interned into symbols. Returns 0 if
+//  the source is too large for 32-bit token offsets.
+static inline int lexerInit(lexer_t *lexer, const source_buffer_t *source, intern_table_t *symbols) {
+    if (source->length > UINT32_MAX) {
+        fprintf(stderr, "Error: source files over 4 GiB are not supported\n");
+        return 0;
+    }
+    lexer->base = source->data;
+    lexer->p = source->data;
+    lexer->end = source->data + source->length;
+    lexer->line_start = source->data;
+    lexer->line = 1;
+    lexer->symbols = symbols;
+    return 1;
+}
+
+//  Lex the next token into *token: run the DFA to its longest match from
+//  each position, skipping whitespace and comments. Returns 0 at the end of
+//  the source.
+static inline int lexerNext(lexer_t *lexer, token_t *token) {
+    const lex_dfa_t *dfa = &lex_dfa;
+    const uint16_t *next = dfa->next;
+    const uint8_t *accepts = dfa->accept;
+    const uint8_t *fast = dfa->fast;
+    const lex_kernels_t *kernels = lex_kernels;
+    const uint8_t *byte_class = dfa->byte_class;
+    const unsigned start_row = LEX_STATE_START * (unsigned)dfa->class_count;
+    const char *p = lexer->p;
+    const char *end = lexer->end;
+    const char *line_start = lexer->line_start;
+    uint32_t line = lexer->line;
+
+    while (p < end) {
+        const char *q = p;
+        const char *token_end = p + 1;
+        int accept = LEX_ACCEPT(TOKEN_UNKNOWN);            //  If no state accepts, one byte
+        unsigned row = start_row;
+        while (q < end) {
+            row = next[row + byte_class[(unsigned char)*q]];
+            if (row == LEX_STATE_DEAD) break;
+            q++;
+            switch (fast[row]) {
+            case LEX_FAST_NONE:
+                break;
+            //  Most blank and identifier runs end within a byte or two, so the
+            //  kernel is only called when the next byte continues the run
+            case LEX_FAST_BLANKS:
+                if (q < end && next[row + byte_class[(unsigned char)*q]] == row) q = kernels->skipBlanks(q, end);
+                break;
+            case LEX_FAST_LINE:
+                q = kernels->findNewline(q, end);
+                break;
+            case LEX_FAST_BLOCK:
+                q = kernels->findCommentEnd(q, end);
+                if (q < end) {
+                    q += 2;
+                    row = dfa->block_end_row;
+                }
+                break;
+            case LEX_FAST_IDENTIFIER:
+                if (q < end && next[row + byte_class[(unsigned char)*q]] == row) q = kernels->skipIdentifier(q, end);
+                break;
+            }
+            int state_accept = accepts[row];
+            if (state_accept != LEX_ACCEPT_NONE) {
+                token_end = q;
+                accept = state_accept;
+            }
+        }
+
+        const char *start = p;
+        uint32_t length = (uint32_t)(token_end - p);
+        p = token_end;
+        if (accept >= LEX_ACCEPT(0)) {
+            size_t column = (size_t)(start - line_start) + 1;
+            token->offset = (uint32_t)(start - lexer->base);
+            token->line = line;
+            token->column = column < UINT16_MAX ? (uint16_t)column : UINT16_MAX;
+            token->reserved = 0;
+            if (accept == LEX_ACCEPT(TOKEN_IDENTIFIER) && isKeyword(start, length)) {
+                token->kind = TOKEN_KEYWORD;
+                token->length = length;
+            } else if (accept == LEX_ACCEPT(TOKEN_IDENTIFIER)) {
+                token->kind = TOKEN_IDENTIFIER;
+                token->symbol = internIdentifier(lexer->symbols, start, length);
+            } else {
+                token->kind = (uint8_t)(accept - LEX_ACCEPT(0));
+                token->length = length;
+            }
+        } else if (accept == LEX_ACCEPT_NEWLINE) {
+            line++;
+            line_start = start + 1;
+        }
+
+        //  Block comments and escaped newlines in literals, terminated or
+        //  not, can span lines
+        if (accept == LEX_ACCEPT_SKIP_LINES || accept == LEX_ACCEPT(TOKEN_STRING) || accept == LEX_ACCEPT(TOKEN_CHARACTER)
+            || accept == LEX_ACCEPT(TOKEN_UNKNOWN)) {
+            for (const char *nl = memchr(start, '\n', length); nl; nl = memchr(nl + 1, '\n', (size_t)(token_end - nl - 1))) {
+                line++;
+                line_start = nl + 1;
+            }
+        }
+        if (accept >= LEX_ACCEPT(0)) {
+            lexer->p = p;
+            lexer->line_start = line_start;
+            lexer->line = line;
+            return 1;
+        }
+    }
+    lexer->p = p;
+    lexer->line_start = line_start;
+    lexer->line = line;
+    return 0;
+}
+
+//  Lex the whole source, handing each token to callback as it is produced.
+//  Returns 0 if the source is too large or the callback stopped early.
+static inline int lexerRun(const source_buffer_t *source, intern_table_t *symbols, lexer_callback_t callback,
+                           void *context) {
+    lexer_t lexer;
+    token_t token;
+    if (!lexerInit(&lexer, source, symbols)) return 0;
+    while (lexerNext(&lexer, &token)) {
+        if (!callback(&token, context)) return 0;
+    }
+    return 1;
+}
+
+#endif // LEXER_H
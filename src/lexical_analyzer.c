@@ -3,17 +3,51 @@ Lexical Analyzer
 
 Features:
 - Tokenizes a C-like input file
-- Multi-character operators (==, !=, <=, >=, ++, --, +=, -=, etc.)
-- Floating-point number recognition (simple)
+- Every C operator and punctuator, including <<=, -> and ...
+- Decimal, octal and hex numbers with fractions, exponents and suffixes
+- String and character literals with escapes
 - Skips comments (single-line and multi-line)
-- Writes tokens to 'tokens.txt' and prints to console
+- Keyword sets for several C dialects and C++ (--dialect)
+- Writes tokens to 'tokens.txt' and prints to console as they are lexed
+- Optionally writes a compact binary token stream, 'tokens.bin', instead
+- Batch mode: lexes whole directory trees on several threads
+
+The lexer core (memory-mapped input, perfect-hash keywords, the
+table-driven DFA and its SIMD fast paths, the streaming lexerNext() and
+lexerRun() API) lives in lexer.h. The binary token format and its reader
+live in token_stream.h.
+
+Batch mode walks the given directories and @file lists for C/C++ sources,
+drops any file named twice (paths are compared after realpath()), then
+runs T C11 worker threads that claim files through an atomic counter.
+Each worker keeps its own identifier intern table, merged at the end for
+the distinct identifier count. With -o every file's token stream is
+written to DIR as <index>_<base name>.tokens.txt.
+
+Usage:
+    lexer.exe [--dialect D] ...         Keyword set D: classic, c89, c99, c11, c17, c23 or cpp
+    lexer.exe [--simd K] ...            Fast-path kernels K: scalar, sse2 or avx2 (default: best available)
+    lexer.exe [--read] [--binary] <source_file.c>
+                                        Tokenize the file (mapped, or block-read with --read) into
+                                        tokens.txt, or tokens.bin with --binary
+    lexer.exe --dump <tokens.bin>       Print a binary token stream as the text table
+    lexer.exe --bench <file> [N]        Lex the file N times per input mode and report MB/s
+    lexer.exe --bench-keywords [N]      N keyword lookups, linear strcmp scan vs perfect hash
+    lexer.exe --bench-dfa <file> [N]    Lex the file N times with the DFA and the old hand-written loop
+    lexer.exe --bench-simd <file> [N]   Lex the file N times with each supported kernel set
+    lexer.exe --bench-literals [K]      Lex K, 2K and 4K KB lines of unterminated literals; fails unless linear
+    lexer.exe --bench-output <file> [N] Write the file's tokens N times as text and as a binary stream
+    lexer.exe --batch [-j T] [-o DIR [-b]] PATH...
+                                        Lex every C/C++ file in the PATHs (files, directories or
+                                        @lists of files) on T threads and print aggregate counts;
+                                        -b writes binary token streams to DIR
 
 For Linux/macOS:
 Replace fopen_s, strcpy_s, etc., with fopen, strcpy, if needed.
 
 Code Structure:
 Includes
-Constants & Macros  
+Constants & Macros
 Struct Definitions
 Global Variables
 Function Declarations
@@ -24,50 +58,204 @@ Build:
 clang -std=c17 -Wall -Wextra -Werror -g -O0 lexical_analyzer.c -o lexer.exe
 */
 
+// mmap(), lstat(), opendir() and sysconf() are POSIX, not ISO C, and
+// realpath() is X/Open; _XOPEN_SOURCE 700 implies POSIX.1-2008 as well
+#if !defined(_WIN32) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 700
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <time.h>
+#include <threads.h>
+#include <stdatomic.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "lexer.h"
+#include "token_stream.h"
 
 // Constants & Macros
-#define MAX_TOKEN_TEXT 128
-#define MAX_TOKENS 2048
-#define TOKEN_TYPE_LENGTH 32
+#define TOKENS_INITIAL_CAPACITY 1024
 #define OUTPUT_TOKEN_FILE "tokens.txt"
+#define OUTPUT_BINARY_FILE "tokens.bin"
+#define BENCH_PASSES 10
+#define BENCH_KEYWORD_LOOKUPS 50000000
+#define BENCH_LITERAL_KB 256                   // Shortest --bench-literals line
+#define BATCH_FILES_INITIAL_CAPACITY 256
+#define BATCH_MAX_THREADS 256
+#define BATCH_PATH_LENGTH 4096
+#define BATCH_NAME_RESERVE 256                 // Room -o DIR must leave for the token file names
 
-// Token Structure
-typedef struct Token {
-char text[MAX_TOKEN_TEXT];
-char type[TOKEN_TYPE_LENGTH];
-} token_t;
-
-// Keyword Table
-static const char *keywords[] = {
-"auto","break","case","char","const","continue","default","do","double",
-"else","enum","extern","float","for","goto","if","inline","int","long",
-"register","restrict","return","short","signed","sizeof","static",
-"struct","switch","typedef","union","unsigned","void","volatile","while",
-"main"
-};
-static const int keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+// Growable token array; doubles when full
+typedef struct TokenBuffer {
+token_t *items;
+size_t count;
+size_t capacity;
+} token_buffer_t;
+
+// Growable list of source file paths for batch mode
+typedef struct FileList {
+char **paths;
+size_t count;
+size_t capacity;
+} file_list_t;
+
+// Batch worker: private intern table, reused for every file it claims, plus
+// its share of the totals
+typedef struct BatchWorker {
+thrd_t thread;
+intern_table_t symbols;
+size_t files;
+size_t failed;
+size_t bytes;
+size_t kind_counts[TOKEN_KIND_COUNT];
+} batch_worker_t;
+
+
+// Token file writer: one table row per token, written as it arrives, or
+// with binary set a token_stream.h stream, written in one piece on close
+typedef struct TokenWriter {
+FILE *out;
+const source_buffer_t *source;
+const intern_table_t *symbols;
+int binary;
+token_stream_writer_t stream;
+size_t bytes;                               // File size, set by closeTokenWriter()
+} token_writer_t;
+
+// Where main() sends each token as it is lexed
+typedef struct TokenSink {
+token_writer_t writer;
+size_t count;
+} token_sink_t;
+
+// Global Variables
+static file_list_t batch_files = { NULL, 0, 0 };
+static atomic_size_t batch_next_file;                  // Next unclaimed index in batch_files
+static const char *batch_output_dir = NULL;
+static int batch_binary = 0;                           // -b: token_stream.h files instead of text
+static size_t batch_unreadable = 0;                    // PATHs, directories and @lists that could not be read
 
 // Function Declarations
-static int isKeyword(const char *word);
-static void pushToken(token_t *tokens, int *token_count, const char *text, const char *type);
-static void lexicalAnalysis(const char *filename, token_t *tokens, int *token_count);
-static void skipSingleLineComment(FILE *f);
-static void skipMultiLineComment(FILE *f);
-static int readOperator(FILE *f, int first, char *out_buffer, size_t out_size);
-static int readNumber(FILE *f, int first, char *out_buffer, size_t out_size);
-static void writeTokensToFile(const char *filename, token_t *tokens, int token_count);
+static int isKeywordLinear(const char *word, size_t length);
+static void pushToken(token_buffer_t *tokens, token_kind_t kind, uint32_t offset, uint32_t length, uint32_t line,
+                      size_t column);
+static void freeTokens(token_buffer_t *tokens);
+static int lexicalAnalysis(const source_buffer_t *source, token_buffer_t *tokens, intern_table_t *symbols);
+static int lexicalAnalysisLegacy(const source_buffer_t *source, token_buffer_t *tokens, intern_table_t *symbols);
+static const char *skipSingleLineComment(const char *p, const char *end);
+static const char *skipMultiLineComment(const char *p, const char *end);
+static size_t readOperator(const char *p, const char *end);
+static size_t readNumber(const char *p, const char *end);
+static int openTokenWriter(token_writer_t *writer, const char *filename, const source_buffer_t *source,
+                           const intern_table_t *symbols, int binary);
+static void writeToken(token_writer_t *writer, const token_t *token);
+static int closeTokenWriter(token_writer_t *writer);
+static int printToken(const token_t *token, void *context);
+static int dumpTokenStream(const char *filename);
+static void benchOutput(const char *filename, int passes);
+static void benchInput(const char *filename, int passes);
+static void benchKeywords(size_t lookups);
+static void benchDfa(const char *filename, int passes);
+static void benchSimd(const char *filename, int passes);
+static void benchLiterals(size_t kilobytes);
+static void addBatchFile(const char *path);
+static int comparePaths(const void *a, const void *b);
+static void removeDuplicateFiles(void);
+static int isSourceFileName(const char *name);
+static void collectSourceFiles(const char *path, int top_level);
+static void collectListedFiles(const char *list_path);
+static int cpuCount(void);
+static int batchWorkerMain(void *arg);
+static int runBatch(int argc, char **argv);
 
 
 // Driver Code
 int main(int argc, char **argv) {
+dialect_t dialect = DIALECT_CLASSIC;
+const char *kernels = NULL;
+while (argc >= 3 && (strcmp(argv[1], "--dialect") == 0 || strcmp(argv[1], "--simd") == 0)) {
+    if (argv[1][2] == 'd' && !parseDialect(argv[2], &dialect)) {
+        fprintf(stderr, "Unknown dialect '%s' (classic, c89, c99, c11, c17, c23 or cpp)\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    if (argv[1][2] == 's') kernels = argv[2];
+    argc -= 2;
+    argv += 2;
+}
+if (!lexerSetup(dialect, kernels)) {
+    fprintf(stderr, "Kernels '%s' are not supported on this CPU (scalar, sse2 or avx2)\n", kernels);
+    return EXIT_FAILURE;
+}
+
+if (argc >= 2 && strcmp(argv[1], "--bench-keywords") == 0) {
+    size_t lookups = argc >= 3 ? strtoull(argv[2], NULL, 10) : BENCH_KEYWORD_LOOKUPS;
+    benchKeywords(lookups ? lookups : BENCH_KEYWORD_LOOKUPS);
+    return EXIT_SUCCESS;
+}
+
+if (argc >= 2 && strcmp(argv[1], "--bench-literals") == 0) {
+    size_t kilobytes = argc >= 3 ? strtoull(argv[2], NULL, 10) : BENCH_LITERAL_KB;
+    benchLiterals(kilobytes ? kilobytes : BENCH_LITERAL_KB);
+    return EXIT_SUCCESS;
+}
+
+if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+    return runBatch(argc - 2, argv + 2);
+}
+
+if (argc >= 3 && strcmp(argv[1], "--bench-simd") == 0) {
+    int passes = argc >= 4 ? atoi(argv[3]) : BENCH_PASSES;
+    benchSimd(argv[2], passes > 0 ? passes : BENCH_PASSES);
+    return EXIT_SUCCESS;
+}
+
+if (argc >= 3 && strcmp(argv[1], "--bench-dfa") == 0) {
+    int passes = argc >= 4 ? atoi(argv[3]) : BENCH_PASSES;
+    benchDfa(argv[2], passes > 0 ? passes : BENCH_PASSES);
+    return EXIT_SUCCESS;
+}
+
+if (argc >= 3 && strcmp(argv[1], "--dump") == 0) {
+    return dumpTokenStream(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+if (argc >= 3 && strcmp(argv[1], "--bench-output") == 0) {
+    int passes = argc >= 4 ? atoi(argv[3]) : BENCH_PASSES;
+    benchOutput(argv[2], passes > 0 ? passes : BENCH_PASSES);
+    return EXIT_SUCCESS;
+}
+
+if (argc >= 3 && strcmp(argv[1], "--bench") == 0) {
+    int passes = argc >= 4 ? atoi(argv[3]) : BENCH_PASSES;
+    benchInput(argv[2], passes > 0 ? passes : BENCH_PASSES);
+    return EXIT_SUCCESS;
+}
+
+int allow_map = 1;
+int binary = 0;
+int arg = 1;
+for (; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--read") == 0) allow_map = 0;
+    else if (strcmp(argv[arg], "--binary") == 0) binary = 1;
+    else break;
+}
+const char *output = binary ? OUTPUT_BINARY_FILE : OUTPUT_TOKEN_FILE;
+
 // Accept source filename either from argv or interactively
 char filename[512];
-if (argc >= 2) {
-    strncpy_s(filename, sizeof(filename), argv[1], _TRUNCATE);
+if (arg < argc) {
+    strncpy_s(filename, sizeof(filename), argv[arg], _TRUNCATE);
 } else {
     printf("Lexical Analyzer - Final\n");
     printf("Enter source filename: ");
@@ -77,261 +265,884 @@ if (argc >= 2) {
     }
 }
 
-token_t tokens[MAX_TOKENS];
-int token_count = 0;
+source_buffer_t source;
+if (!openSource(filename, allow_map, &source)) {
+    fprintf(stderr, "Error: cannot open source file '%s'\n", filename);
+    return EXIT_FAILURE;
+}
+
 
-lexicalAnalysis(filename, tokens, &token_count);
+intern_table_t symbols;
+initInternTable(&symbols);
 
-// Print tokens to console
+// Lex, print and write in one pass: each token is handled as it is produced
+token_sink_t sink;
+memset(&sink, 0, sizeof(sink));
+int saved = openTokenWriter(&sink.writer, output, &source, &symbols, binary);
 printf("-------------------------------------\n");
-printf(" Lexical Analysis Result (tokens found: %d)\n", token_count);
+printf(" Lexical Analysis Result\n");
 printf("-------------------------------------\n");
-for (int i = 0; i < token_count; ++i) {
-    printf("%-20s -> %s\n", tokens[i].text, tokens[i].type);
+int ok = lexerRun(&source, &symbols, printToken, &sink);
+if (saved && !closeTokenWriter(&sink.writer)) saved = 0;
+if (!ok) {
+    freeInternTable(&symbols);
+    closeSource(&source);
+    return EXIT_FAILURE;
 }
 printf("-------------------------------------\n");
+printf(" Tokens found: %zu\n", sink.count);
+printf(" Distinct identifiers: %u\n", (unsigned)symbols.count);
+if (saved) printf("Tokens saved to '%s' (%zu bytes)\n", output, sink.writer.bytes);
 
-// Write tokens to file
-writeTokensToFile(OUTPUT_TOKEN_FILE, tokens, token_count);
-printf("Tokens saved to '%s'\n", OUTPUT_TOKEN_FILE);
-
+freeInternTable(&symbols);
+closeSource(&source);
 return EXIT_SUCCESS;
 }
 
-// Function Declarations
-// Check if word is a keyword
-static int isKeyword(const char *word) {
-for (int i = 0; i < keyword_count; ++i) {
-    if (strcmp(word, keywords[i]) == 0) return 1;
+// Function Definitions
+// The original strcmp scan over every keyword, kept for benchKeywords()
+static int isKeywordLinear(const char *word, size_t length) {
+for (int i = 0; i < keyword_table.count; ++i) {
+    if (strncmp(word, keyword_table.entries[i].text, length) == 0 && keyword_table.entries[i].text[length] == '\0') return 1;
 }
 return 0;
 }
 
-// Push a token safely into the token array
-static void pushToken(token_t *tokens, int *token_count, const char *text, const char *type) {
-if (*token_count >= MAX_TOKENS) {
-    fprintf(stderr, "Warning: token buffer full, dropping token '%s'\n", text);
-    return;
+// Append a token, doubling the array when it is full
+static void pushToken(token_buffer_t *tokens, token_kind_t kind, uint32_t offset, uint32_t length, uint32_t line,
+                      size_t column) {
+if (tokens->count == tokens->capacity) {
+    size_t new_capacity = tokens->capacity ? tokens->capacity * 2 : TOKENS_INITIAL_CAPACITY;
+    token_t *items = realloc(tokens->items, new_capacity * sizeof(*items));
+    if (!items) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    tokens->items = items;
+    tokens->capacity = new_capacity;
 }
-strncpy_s(tokens[*token_count].text, MAX_TOKEN_TEXT, text, _TRUNCATE);
-strncpy_s(tokens[*token_count].type, TOKEN_TYPE_LENGTH, type, _TRUNCATE);
-(*token_count)++;
+token_t *token = &tokens->items[tokens->count++];
+token->offset = offset;
+token->length = length;
+token->line = line;
+token->column = column < UINT16_MAX ? (uint16_t)column : UINT16_MAX;
+token->kind = (uint8_t)kind;
+token->reserved = 0;
 }
 
-// Skip single-line comment: consume until newline or EOF
-static void skipSingleLineComment(FILE *f) {
-int c;
-while ((c = fgetc(f)) != EOF) {
-    if (c == '\n') break;
+static void freeTokens(token_buffer_t *tokens) {
+free(tokens->items);
+tokens->items = NULL;
+tokens->count = tokens->capacity = 0;
 }
+
+// Skip single-line comment: returns the newline (or end)
+static const char *skipSingleLineComment(const char *p, const char *end) {
+const char *newline = memchr(p, '\n', (size_t)(end - p));
+return newline ? newline : end;
 }
 
-// Skip multi-line comment: consume until "*/" or EOF
-static void skipMultiLineComment(FILE *f) {
-int prev = 0, curr;
-while ((curr = fgetc(f)) != EOF) {
-    if (prev == '*' && curr == '/') break;
-    prev = curr;
+// Skip multi-line comment body: returns the byte after "*/" (or end)
+static const char *skipMultiLineComment(const char *p, const char *end) {
+while (p < end) {
+    const char *star = memchr(p, '*', (size_t)(end - p));
+    if (!star || star + 1 >= end) return end;
+    if (star[1] == '/') return star + 2;
+    p = star + 1;
 }
+return end;
 }
 
 // Read operator: supports multi-character operators.
-// Returns 1 on success, 0 otherwise. Fills out_buffer.
-// (caller should ensure out_buffer has enough space)
-static int readOperator(FILE *f, int first, char *out_buffer, size_t out_size) {
-// Multi-character operator candidates
-int second = fgetc(f);
-if (second == EOF) {
-    // only first
-    if (out_size) {
-        out_buffer[0] = (char)first;
-        out_buffer[1] = '\0';
-    }
-    return 1;
-}
+// Returns the operator length (1 or 2).
+static size_t readOperator(const char *p, const char *end) {
+if (p + 1 >= end) return 1;
+int first = p[0], second = p[1];
 
 // common combos to recognize
-int matched = 0;
-if (first == '=' && second == '=') matched = 1;
-else if (first == '!' && second == '=') matched = 1;
-else if (first == '<' && second == '=') matched = 1;
-else if (first == '>' && second == '=') matched = 1;
-else if (first == '+' && second == '+') matched = 1;
-else if (first == '-' && second == '-') matched = 1;
-else if (first == '+' && second == '=') matched = 1;
-else if (first == '-' && second == '=') matched = 1;
-else if (first == '&' && second == '&') matched = 1;
-else if (first == '|' && second == '|') matched = 1;
-else if (first == '/' && second == '=') matched = 1;
-else if (first == '*' && second == '=') matched = 1;
-
-if (matched) {
-    if (out_size) {
-        out_buffer[0] = (char)first;
-        out_buffer[1] = (char)second;
-        out_buffer[2] = '\0';
-    }
-    return 1;
-}
-
-// not a multi-character operator — push second back and return single
-ungetc(second, f);
-if (out_size) {
-    out_buffer[0] = (char)first;
-    out_buffer[1] = '\0';
-}
+if (first == '=' && second == '=') return 2;
+if (first == '!' && second == '=') return 2;
+if (first == '<' && second == '=') return 2;
+if (first == '>' && second == '=') return 2;
+if (first == '+' && second == '+') return 2;
+if (first == '-' && second == '-') return 2;
+if (first == '+' && second == '=') return 2;
+if (first == '-' && second == '=') return 2;
+if (first == '&' && second == '&') return 2;
+if (first == '|' && second == '|') return 2;
+if (first == '/' && second == '=') return 2;
+if (first == '*' && second == '=') return 2;
 return 1;
 }
 
 // Read number token -> supports simple floating point (one dot).
-// Returns 1 and fills out_buffer; caller gets stream positioned after
-// the last digit/dot. If non-number start, behavior is undefined.
-static int readNumber(FILE *f, int first, char *out_buffer, size_t out_size) {
-size_t idx = 0;
-int c = first;
+// p is at the first digit; returns the length up to the last digit/dot.
+static size_t readNumber(const char *p, const char *end) {
+const char *start = p++;
 int seen_dot = 0;
 
-// store first char
-if (idx + 1 < out_size) out_buffer[idx++] = (char)c;
-else { out_buffer[0] = '\0'; return 0; }
-
-while (1) {
-    int next = fgetc(f);
-    if (next == EOF) break;
-
-    if (next == '.') {
-        if (seen_dot) { // second dot -> stop and push back
-            ungetc(next, f);
-            break;
-        } else {
-            seen_dot = 1;
-            if (idx + 1 < out_size) out_buffer[idx++] = '.';
-            else break;
-            continue;
-        }
-    }
-
-    if (isdigit(next)) {
-        if (idx + 1 < out_size) out_buffer[idx++] = (char)next;
-        else { /* truncated */ }
-    } else {
-        // end of number
-        ungetc(next, f);
+while (p < end) {
+    if (*p == '.') {
+        if (seen_dot) break;                        // second dot ends the number
+        seen_dot = 1;
+    } else if (!isdigit((unsigned char)*p)) {
         break;
     }
+    p++;
+}
+return (size_t)(p - start);
 }
 
-// null terminate
-if (idx < out_size) out_buffer[idx] = '\0';
-else out_buffer[out_size - 1] = '\0';
+// Collect every token of source into tokens, for the benchmarks that keep
+// the whole stream. Returns 0 if the source is too large.
+static int lexicalAnalysis(const source_buffer_t *source, token_buffer_t *tokens, intern_table_t *symbols) {
+lexer_t lexer;
+token_t token;
+tokens->count = 0;
+if (!lexerInit(&lexer, source, symbols)) return 0;
+while (lexerNext(&lexer, &token)) pushToken(tokens, token.kind, token.offset, token.length, token.line, token.column);
 return 1;
 }
 
-// Lexical analysis main loop
-static void lexicalAnalysis(const char *filename, token_t *tokens, int *token_count) {
-FILE *source_file = NULL;
-errno_t err = fopen_s(&source_file, filename, "r");
-if (err != 0 || !source_file) {
-    fprintf(stderr, "Error: cannot open source file '%s'\n", filename);
-    return;
+// The original hand-written loop (isspace/isalpha/strchr and readOperator()),
+// kept for --bench-dfa
+static int lexicalAnalysisLegacy(const source_buffer_t *source, token_buffer_t *tokens, intern_table_t *symbols) {
+if (source->length > UINT32_MAX) {
+    fprintf(stderr, "Error: source files over 4 GiB are not supported\n");
+    return 0;
 }
 
-*token_count = 0;
+const char *base = source->data;
+const char *p = base;
+const char *end = base + source->length;
+const char *line_start = base;
+uint32_t line = 1;
 
-int raw;
-char buffer[MAX_TOKEN_TEXT];
+tokens->count = 0;
 
-while ((raw = fgetc(source_file)) != EOF) {
-    char ch = (char)raw;
+while (p < end) {
+    const char *start = p;
+    char ch = *p++;
+    uint32_t offset = (uint32_t)(start - base);
+    size_t column = (size_t)(start - line_start) + 1;
 
     // Skip whitespace
-    if (isspace((unsigned char)ch)) continue;
+    if (isspace((unsigned char)ch)) {
+        if (ch == '\n') {
+            line++;
+            line_start = p;
+        }
+        continue;
+    }
 
     // Handle comments or divide operator start
-    if (ch == '/') {
-        int next = fgetc(source_file);
-        if (next == '/') {
-            // single-line comment
-            skipSingleLineComment(source_file);
-            continue;
-        } else if (next == '*') {
-            // multi-line comment
-            skipMultiLineComment(source_file);
+    if (ch == '/' && p < end) {
+        if (*p == '/') {
+            // single-line comment (the newline is left for the whitespace case)
+            p = skipSingleLineComment(p + 1, end);
             continue;
-        } else {
-            // could be operator /= or just /
-            ungetc(next, source_file);
-            readOperator(source_file, ch, buffer, sizeof(buffer));
-            pushToken(tokens, token_count, buffer, "OPERATOR");
+        } else if (*p == '*') {
+            // multi-line comment: count the lines it spans
+            const char *body = p + 1;
+            p = skipMultiLineComment(body, end);
+            for (const char *nl = memchr(body, '\n', (size_t)(p - body)); nl; nl = memchr(nl + 1, '\n', (size_t)(p - nl - 1))) {
+                line++;
+                line_start = nl + 1;
+            }
             continue;
         }
     }
 
     // Identifiers or keywords (start with letter or underscore)
     if (isalpha((unsigned char)ch) || ch == '_') {
-        size_t idx = 0;
-        buffer[idx++] = ch;
-        while (1) {
-            int nxt = fgetc(source_file);
-            if (nxt == EOF) break;
-            if (isalnum((unsigned char)nxt) || nxt == '_') {
-                if (idx + 1 < sizeof(buffer)) buffer[idx++] = (char)nxt;
-                else { /* truncate if overflow */ }
-            } else {
-                ungetc(nxt, source_file);
-                break;
-            }
-        }
-        buffer[idx] = '\0';
-        if (isKeyword(buffer)) pushToken(tokens, token_count, buffer, "KEYWORD");
-        else pushToken(tokens, token_count, buffer, "IDENTIFIER");
+        while (p < end && (isalnum((unsigned char)*p) || *p == '_')) p++;
+        size_t length = (size_t)(p - start);
+        if (isKeyword(start, length)) pushToken(tokens, TOKEN_KEYWORD, offset, (uint32_t)length, line, column);
+        else pushToken(tokens, TOKEN_IDENTIFIER, offset, internIdentifier(symbols, start, length), line, column);
         continue;
     }
 
     // Numbers (integer or float). Start with digit
     if (isdigit((unsigned char)ch)) {
-        if (readNumber(source_file, ch, buffer, sizeof(buffer)))
-            pushToken(tokens, token_count, buffer, "NUMBER");
+        p = start + readNumber(start, end);
+        pushToken(tokens, TOKEN_NUMBER, offset, (uint32_t)(p - start), line, column);
         continue;
     }
 
     // Operators (single or multi char) and punctuation/delimiters
-    if (strchr("+-*=<>!&|%^", ch)) {
-        readOperator(source_file, ch, buffer, sizeof(buffer));
-        pushToken(tokens, token_count, buffer, "OPERATOR");
+    if (strchr("+-*/=<>!&|%^", ch)) {
+        p = start + readOperator(start, end);
+        pushToken(tokens, TOKEN_OPERATOR, offset, (uint32_t)(p - start), line, column);
         continue;
     }
 
     // Punctuation / delimiters
     if (strchr(";:,(){}[].", ch)) {
-        char s[2] = { ch, '\0' };
-        pushToken(tokens, token_count, s, "DELIMITER");
+        pushToken(tokens, TOKEN_DELIMITER, offset, 1, line, column);
         continue;
     }
 
     // Anything else -> assign an unknown token
-    {
-        char s[2] = { ch, '\0' };
-        pushToken(tokens, token_count, s, "UNKNOWN");
+    pushToken(tokens, TOKEN_UNKNOWN, offset, 1, line, column);
+}
+return 1;
+}
+
+// Token file writer: header rows (or the stream encoder) on open, then one
+// row per writeToken()
+static int openTokenWriter(token_writer_t *writer, const char *filename, const source_buffer_t *source,
+                           const intern_table_t *symbols, int binary) {
+memset(writer, 0, sizeof(*writer));
+writer->source = source;
+writer->symbols = symbols;
+writer->binary = binary;
+errno_t err = fopen_s(&writer->out, filename, binary ? "wb" : "w");
+if (err != 0 || !writer->out) {
+    fprintf(stderr, "Error: cannot open token output file '%s'\n", filename);
+    writer->out = NULL;
+    return 0;
+}
+if (binary) {
+    tokenStreamWriterInit(&writer->stream, source->length);
+} else {
+    fprintf(writer->out, "%-20s | %s\n", "TOKEN", "TYPE");
+    fprintf(writer->out, "-------------------------------------\n");
+}
+return 1;
+}
+
+static void writeToken(token_writer_t *writer, const token_t *token) {
+size_t length;
+const char *text = tokenText(writer->source, writer->symbols, token, &length);
+if (writer->binary) tokenStreamWrite(&writer->stream, token, text, length);
+else fprintf(writer->out, "%-20.*s | %s\n", (int)length, text, token_kind_names[token->kind]);
+}
+
+// Returns 0 if the file could not be written completely
+static int closeTokenWriter(token_writer_t *writer) {
+if (!writer->out) return 0;
+int ok = 1;
+if (writer->binary) {
+    ok = tokenStreamSave(&writer->stream, writer->out);
+    writer->bytes = writer->stream.length;
+    tokenStreamWriterFree(&writer->stream);
+} else {
+    long end = ftell(writer->out);
+    writer->bytes = end > 0 ? (size_t)end : 0;
+}
+// A write error flushed before this point (ENOSPC partway through a large
+// table) only shows in the stream's error flag, not in fclose()
+if (ferror(writer->out)) ok = 0;
+if (fclose(writer->out) != 0) ok = 0;
+writer->out = NULL;
+if (!ok) fprintf(stderr, "Error: writing the token output file failed\n");
+return ok;
+}
+
+// lexerRun() callback for main(): print the token and write its row
+static int printToken(const token_t *token, void *context) {
+token_sink_t *sink = context;
+size_t length;
+const char *text = tokenText(sink->writer.source, sink->writer.symbols, token, &length);
+printf("%-20.*s -> %s\n", (int)length, text, token_kind_names[token->kind]);
+if (sink->writer.out) writeToken(&sink->writer, token);
+sink->count++;
+return 1;
+}
+
+// Batch Mode Functions
+static void addBatchFile(const char *path) {
+if (batch_files.count == batch_files.capacity) {
+    size_t new_capacity = batch_files.capacity ? batch_files.capacity * 2 : BATCH_FILES_INITIAL_CAPACITY;
+    char **paths = realloc(batch_files.paths, new_capacity * sizeof(*paths));
+    if (!paths) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
     }
+    batch_files.paths = paths;
+    batch_files.capacity = new_capacity;
 }
 
-fclose(source_file);
+// Store the absolute path (symbolic links resolved on POSIX), so a file
+// reached through a directory and an @list compares equal in
+// removeDuplicateFiles(); fall back to the path as given
+#if defined(_WIN32)
+char *copy = _fullpath(NULL, path, 0);
+#else
+char *copy = realpath(path, NULL);
+#endif
+if (!copy) {
+    size_t length = strlen(path);
+    copy = malloc(length + 1);
+    if (!copy) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, path, length + 1);
+}
+batch_files.paths[batch_files.count++] = copy;
 }
 
-// Write tokens to text file
-static void writeTokensToFile(const char *filename, token_t *tokens, int token_count) {
-FILE *out = NULL;
-errno_t err = fopen_s(&out, filename, "w");
-if (err != 0 || !out) {
-    fprintf(stderr, "Error: cannot open token output file '%s'\n", filename);
+static int comparePaths(const void *a, const void *b) {
+return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Sort batch_files and drop repeated paths, so no file is lexed twice
+static void removeDuplicateFiles(void) {
+if (batch_files.count < 2) return;
+qsort(batch_files.paths, batch_files.count, sizeof(*batch_files.paths), comparePaths);
+size_t kept = 1;
+for (size_t i = 1; i < batch_files.count; i++) {
+    if (strcmp(batch_files.paths[i], batch_files.paths[kept - 1]) == 0) free(batch_files.paths[i]);
+    else batch_files.paths[kept++] = batch_files.paths[i];
+}
+batch_files.count = kept;
+}
+
+static int isSourceFileName(const char *name) {
+static const char *extensions[] = { ".c", ".h", ".cc", ".cpp", ".cxx", ".hh", ".hpp" };
+const char *dot = strrchr(name, '.');
+if (!dot) return 0;
+for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); ++i) {
+    if (strcmp(dot, extensions[i]) == 0) return 1;
+}
+return 0;
+}
+
+// Add path if it is a file, or every source file below it if it is a
+// directory. Files named on the command line are taken whatever their
+// extension; symbolic links below the top level are not followed.
+static void collectSourceFiles(const char *path, int top_level) {
+char child[BATCH_PATH_LENGTH];
+#if defined(_WIN32)
+DWORD attributes = GetFileAttributesA(path);
+if (attributes == INVALID_FILE_ATTRIBUTES) {
+    fprintf(stderr, "Warning: cannot access '%s'\n", path);
+    batch_unreadable++;
+    return;
+}
+if (!(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+    if (top_level || isSourceFileName(path)) addBatchFile(path);
+    return;
+}
+snprintf(child, sizeof(child), "%s\\*", path);
+WIN32_FIND_DATAA entry;
+HANDLE find = FindFirstFileA(child, &entry);
+if (find == INVALID_HANDLE_VALUE) {
+    fprintf(stderr, "Warning: cannot read directory '%s'\n", path);
+    batch_unreadable++;
+    return;
+}
+do {
+    if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0) continue;
+    if (entry.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+    snprintf(child, sizeof(child), "%s\\%s", path, entry.cFileName);
+    if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) collectSourceFiles(child, 0);
+    else if (isSourceFileName(entry.cFileName)) addBatchFile(child);
+} while (FindNextFileA(find, &entry));
+FindClose(find);
+#else
+struct stat info;
+if ((top_level ? stat(path, &info) : lstat(path, &info)) != 0) {
+    fprintf(stderr, "Warning: cannot access '%s'\n", path);
+    batch_unreadable++;
+    return;
+}
+if (S_ISREG(info.st_mode)) {
+    if (top_level || isSourceFileName(path)) addBatchFile(path);
     return;
 }
+if (!S_ISDIR(info.st_mode)) return;
+DIR *dir = opendir(path);
+if (!dir) {
+    fprintf(stderr, "Warning: cannot read directory '%s'\n", path);
+    batch_unreadable++;
+    return;
+}
+struct dirent *entry;
+while ((entry = readdir(dir)) != NULL) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+    snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+    collectSourceFiles(child, 0);
+}
+closedir(dir);
+#endif
+}
+
+// One path per line; blank lines are skipped
+static void collectListedFiles(const char *list_path) {
+FILE *list = NULL;
+errno_t err = fopen_s(&list, list_path, "r");
+if (err != 0 || !list) {
+    fprintf(stderr, "Warning: cannot open file list '%s'\n", list_path);
+    batch_unreadable++;
+    return;
+}
+char line[BATCH_PATH_LENGTH];
+while (fgets(line, sizeof(line), list)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0]) collectSourceFiles(line, 1);
+}
+fclose(list);
+}
+
+static int cpuCount(void) {
+#if defined(_WIN32)
+SYSTEM_INFO info;
+GetSystemInfo(&info);
+return (int)info.dwNumberOfProcessors;
+#else
+long count = sysconf(_SC_NPROCESSORS_ONLN);
+return count > 0 ? (int)count : 1;
+#endif
+}
+
+// Claim files until none are left; count each file's tokens (and write its
+// token file with -o) as they are lexed
+static int batchWorkerMain(void *arg) {
+batch_worker_t *worker = arg;
+size_t index;
+while ((index = atomic_fetch_add_explicit(&batch_next_file, 1, memory_order_relaxed)) < batch_files.count) {
+    const char *path = batch_files.paths[index];
+    source_buffer_t source;
+    if (!openSource(path, 1, &source)) {
+        fprintf(stderr, "Warning: cannot open source file '%s'\n", path);
+        worker->failed++;
+        continue;
+    }
+    lexer_t lexer;
+    if (!lexerInit(&lexer, &source, &worker->symbols)) {
+        worker->failed++;
+        closeSource(&source);
+        continue;
+    }
+
+    token_writer_t writer;
+    memset(&writer, 0, sizeof(writer));
+    if (batch_output_dir) {
+        char output[BATCH_PATH_LENGTH];
+        // Index plus base name: unique even when two paths mangle alike
+        const char *base = path;
+        for (const char *c = path; *c; ++c) {
+            if (*c == '/' || *c == '\\' || *c == ':') base = c + 1;
+        }
+        int length = snprintf(output, sizeof(output), "%s/%zu_%s%s", batch_output_dir, index, base,
+                              batch_binary ? ".tokens.bin" : ".tokens.txt");
+        if (length < 0 || length >= (int)sizeof(output)) {
+            fprintf(stderr, "Warning: token file name for '%s' is too long\n", path);
+            worker->failed++;
+            closeSource(&source);
+            continue;
+        }
+        if (!openTokenWriter(&writer, output, &source, &worker->symbols, batch_binary)) {
+            worker->failed++;
+            closeSource(&source);
+            continue;
+        }
+    }
+
+    // Count locally: workers sit next to each other in one array
+    size_t kind_counts[TOKEN_KIND_COUNT] = { 0 };
+    token_t token;
+    while (lexerNext(&lexer, &token)) {
+        kind_counts[token.kind]++;
+        if (writer.out) writeToken(&writer, &token);
+    }
+    if (batch_output_dir && !closeTokenWriter(&writer)) {
+        worker->failed++;
+        closeSource(&source);
+        continue;
+    }
+    for (int k = 0; k < TOKEN_KIND_COUNT; ++k) worker->kind_counts[k] += kind_counts[k];
+    worker->files++;
+    worker->bytes += source.length;
+    closeSource(&source);
+}
+return 0;
+}
+
+static int runBatch(int argc, char **argv) {
+int thread_count = cpuCount();
+int arg = 0;
+for (; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) thread_count = atoi(argv[++arg]);
+    else if (strcmp(argv[arg], "-o") == 0 && arg + 1 < argc) batch_output_dir = argv[++arg];
+    else if (strcmp(argv[arg], "-b") == 0) batch_binary = 1;
+    else break;
+}
+if (thread_count < 1) thread_count = 1;
+if (thread_count > BATCH_MAX_THREADS) thread_count = BATCH_MAX_THREADS;
+if (arg == argc) {
+    fprintf(stderr, "Usage: lexer.exe --batch [-j T] [-o DIR [-b]] PATH...\n");
+    return EXIT_FAILURE;
+}
+if (batch_output_dir && strlen(batch_output_dir) >= BATCH_PATH_LENGTH - BATCH_NAME_RESERVE) {
+    fprintf(stderr, "Error: output directory name is too long\n");
+    return EXIT_FAILURE;
+}
+
+for (; arg < argc; arg++) {
+    if (argv[arg][0] == '@') collectListedFiles(argv[arg] + 1);
+    else collectSourceFiles(argv[arg], 1);
+}
+removeDuplicateFiles();
+
+batch_worker_t *workers = calloc((size_t)thread_count, sizeof(*workers));
+if (!workers) {
+    fprintf(stderr, "ERROR: Memory allocation failed.\n");
+    exit(EXIT_FAILURE);
+}
+atomic_store(&batch_next_file, 0);
+
+struct timespec start, now;
+timespec_get(&start, TIME_UTC);
+for (int t = 0; t < thread_count; t++) {
+    initInternTable(&workers[t].symbols);
+    if (thrd_create(&workers[t].thread, batchWorkerMain, &workers[t]) != thrd_success) {
+        fprintf(stderr, "ERROR: Thread creation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+for (int t = 0; t < thread_count; t++) thrd_join(workers[t].thread, NULL);
+timespec_get(&now, TIME_UTC);
+double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+
+// Merge: sum the counts and intern every worker's identifiers into one table
+intern_table_t merged;
+initInternTable(&merged);
+size_t files = 0, failed = batch_unreadable, bytes = 0, tokens = 0;
+size_t kind_counts[TOKEN_KIND_COUNT] = { 0 };
+for (int t = 0; t < thread_count; t++) {
+    batch_worker_t *worker = &workers[t];
+    files += worker->files;
+    failed += worker->failed;
+    bytes += worker->bytes;
+    for (int k = 0; k < TOKEN_KIND_COUNT; k++) {
+        kind_counts[k] += worker->kind_counts[k];
+        tokens += worker->kind_counts[k];
+    }
+    for (uint32_t i = 0; i < worker->symbols.count; i++) {
+        const symbol_t *symbol = &worker->symbols.symbols[i];
+        internIdentifier(&merged, worker->symbols.text + symbol->offset, symbol->length);
+    }
+}
+
+printf("-------------------------------------\n");
+printf(" Batch Lexical Analysis (%d threads)\n", thread_count);
+printf("-------------------------------------\n");
+for (int k = 0; k < TOKEN_KIND_COUNT; k++) printf("%-20s %zu\n", token_kind_names[k], kind_counts[k]);
+printf("-------------------------------------\n");
+printf(" Files: %zu (%zu failed)  Bytes: %zu  Tokens: %zu\n", files, failed, bytes, tokens);
+printf(" Distinct identifiers: %u\n", (unsigned)merged.count);
+printf(" %.3f s  (%.1f MB/s, %.0f files/s)\n", seconds, seconds > 0.0 ? (double)bytes / seconds / 1e6 : 0.0,
+       seconds > 0.0 ? (double)files / seconds : 0.0);
+for (int t = 0; t < thread_count; t++)
+    printf("   thread %-3d %zu files, %zu bytes\n", t, workers[t].files, workers[t].bytes);
+if (batch_output_dir && !failed) printf("Token streams saved to '%s'\n", batch_output_dir);
+
+for (int t = 0; t < thread_count; t++) freeInternTable(&workers[t].symbols);
+free(workers);
+freeInternTable(&merged);
+for (size_t i = 0; i < batch_files.count; i++) free(batch_files.paths[i]);
+free(batch_files.paths);
+return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// Open and lex the file `passes` times in each input mode, reusing one token
+// buffer, and report throughput
+static void benchInput(const char *filename, int passes) {
+static const char *mode_names[] = { "block read", "mapped" };
+for (int allow_map = 0; allow_map <= 1; allow_map++) {
+    size_t bytes = 0;
+    token_buffer_t tokens = { NULL, 0, 0 };
+    uint32_t symbol_count = 0;
+    struct timespec start, now;
+    timespec_get(&start, TIME_UTC);
+    for (int pass = 0; pass < passes; pass++) {
+        source_buffer_t source;
+        if (!openSource(filename, allow_map, &source)) {
+            fprintf(stderr, "Error: cannot open source file '%s'\n", filename);
+            exit(EXIT_FAILURE);
+        }
+        intern_table_t symbols;
+        initInternTable(&symbols);
+        if (!lexicalAnalysis(&source, &tokens, &symbols)) exit(EXIT_FAILURE);
+        bytes += source.length;
+        symbol_count = symbols.count;
+        freeInternTable(&symbols);
+        closeSource(&source);
+    }
+    timespec_get(&now, TIME_UTC);
+    double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%-10s  %d passes over %zu bytes in %.3f s  (%.1f MB/s, %zu tokens in %zu KB, %u identifiers)\n",
+           mode_names[allow_map], passes, bytes / (size_t)passes, seconds,
+           seconds > 0.0 ? (double)bytes / seconds / 1e6 : 0.0, tokens.count, tokens.capacity * sizeof(token_t) / 1024,
+           (unsigned)symbol_count);
+    freeTokens(&tokens);
+}
+}
+
+// Look up a mix of keywords and typical identifiers with the linear scan and
+// the perfect hash; both must agree on every word
+static void benchKeywords(size_t lookups) {
+static const char *identifiers[] = {
+    "i", "j", "n", "count", "buffer", "length", "source", "token", "tokens", "printf", "fprintf", "memcpy",
+    "size_t", "uint32_t", "NULL", "result", "index", "value", "next", "table", "entry", "stderr", "data",
+    "main_loop", "integer", "returned", "structure", "whiles", "do_work", "if_ready", "format", "capacity"
+};
+size_t identifier_count = sizeof(identifiers) / sizeof(identifiers[0]);
+size_t word_count = (size_t)keyword_table.count + identifier_count;
+const char **words = malloc(word_count * sizeof(*words));
+size_t *lengths = malloc(word_count * sizeof(*lengths));
+if (!words || !lengths) {
+    fprintf(stderr, "ERROR: Memory allocation failed.\n");
+    exit(EXIT_FAILURE);
+}
+for (int i = 0; i < keyword_table.count; ++i) words[i] = keyword_table.entries[i].text;
+for (size_t i = 0; i < identifier_count; ++i) words[keyword_table.count + i] = identifiers[i];
+for (size_t i = 0; i < word_count; ++i) lengths[i] = strlen(words[i]);
+
+for (size_t i = 0; i < word_count; ++i) {
+    if (isKeyword(words[i], lengths[i]) != isKeywordLinear(words[i], lengths[i])) {
+        fprintf(stderr, "ERROR: Lookups disagree on '%s'.\n", words[i]);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static const char *method_names[] = { "linear scan", "perfect hash" };
+for (int method = 0; method < 2; method++) {
+    size_t hits = 0, w = 0;
+    struct timespec start, now;
+    timespec_get(&start, TIME_UTC);
+    for (size_t i = 0; i < lookups; i++) {
+        hits += method ? isKeyword(words[w], lengths[w]) : isKeywordLinear(words[w], lengths[w]);
+        w = w + 7 < word_count ? w + 7 : w + 7 - word_count;
+    }
+    timespec_get(&now, TIME_UTC);
+    double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%-12s  %zu lookups in %.3f s  (%.1f ns/lookup, %zu hits)\n", method_names[method], lookups, seconds,
+           seconds * 1e9 / (double)lookups, hits);
+}
+printf("%d keywords in %zu slots, seed 0x%08X\n", keyword_table.count, (size_t)1 << (32 - keyword_table.shift),
+       (unsigned)keyword_table.seed);
+
+free(words);
+free(lengths);
+}
+
+// Lex the mapped file `passes` times with the DFA core and with the old
+// hand-written loop, and report throughput of each
+static void benchDfa(const char *filename, int passes) {
+static const char *core_names[] = { "hand-written", "dfa" };
+source_buffer_t source;
+if (!openSource(filename, 1, &source)) {
+    fprintf(stderr, "Error: cannot open source file '%s'\n", filename);
+    exit(EXIT_FAILURE);
+}
+
+for (int core = 0; core < 2; core++) {
+    token_buffer_t tokens = { NULL, 0, 0 };
+    struct timespec start, now;
+    timespec_get(&start, TIME_UTC);
+    for (int pass = 0; pass < passes; pass++) {
+        intern_table_t symbols;
+        initInternTable(&symbols);
+        int ok = core ? lexicalAnalysis(&source, &tokens, &symbols) : lexicalAnalysisLegacy(&source, &tokens, &symbols);
+        freeInternTable(&symbols);
+        if (!ok) exit(EXIT_FAILURE);
+    }
+    timespec_get(&now, TIME_UTC);
+    double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    double bytes = (double)source.length * passes;
+    printf("%-12s  %d passes over %zu bytes in %.3f s  (%.1f MB/s, %zu tokens)\n", core_names[core], passes,
+           source.length, seconds, seconds > 0.0 ? bytes / seconds / 1e6 : 0.0, tokens.count);
+    freeTokens(&tokens);
+}
+printf("%d states x %d byte classes = %d byte table\n", lex_dfa.state_count, lex_dfa.class_count,
+       lex_dfa.state_count * lex_dfa.class_count);
+closeSource(&source);
+}
+
+// Lex the mapped file `passes` times with every kernel set this CPU runs;
+// all must produce the same tokens
+static void benchSimd(const char *filename, int passes) {
+source_buffer_t source;
+if (!openSource(filename, 1, &source)) {
+    fprintf(stderr, "Error: cannot open source file '%s'\n", filename);
+    exit(EXIT_FAILURE);
+}
+
+token_buffer_t reference = { NULL, 0, 0 };
+int ok = 1;
+for (int i = 0; i < lex_kernel_set_count; i++) {
+    if (!selectLexKernels(lex_kernel_sets[i].name)) continue;
+    token_buffer_t tokens = { NULL, 0, 0 };
+    struct timespec start, now;
+    timespec_get(&start, TIME_UTC);
+    for (int pass = 0; pass < passes; pass++) {
+        intern_table_t symbols;
+        initInternTable(&symbols);
+        if (!lexicalAnalysis(&source, &tokens, &symbols)) exit(EXIT_FAILURE);
+        freeInternTable(&symbols);
+    }
+    timespec_get(&now, TIME_UTC);
+    double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    double bytes = (double)source.length * passes;
+
+    int same = 1;
+    if (!reference.items) {
+        reference = tokens;
+        tokens.items = NULL;
+    } else {
+        same = tokens.count == reference.count &&
+               memcmp(tokens.items, reference.items, tokens.count * sizeof(token_t)) == 0;
+        ok &= same;
+    }
+    printf("%-8s  %d passes over %zu bytes in %.3f s  (%.1f MB/s, %zu tokens)  %s\n", lex_kernel_sets[i].name,
+           passes, source.length, seconds, seconds > 0.0 ? bytes / seconds / 1e6 : 0.0, reference.count,
+           same ? "OK" : "MISMATCH");
+    freeTokens(&tokens);
+}
+freeTokens(&reference);
+closeSource(&source);
+if (!ok) exit(EXIT_FAILURE);
+}
+
+// Regression input for unterminated literals: one line of "\ (and one of
+// '\) repeated, which a lexer that re-scans after a failed match takes
+// quadratic time on. Lex it at 1x, 2x and 4x the size; 4x may take at most
+// 8x as long.
+static void benchLiterals(size_t kilobytes) {
+static const char *const shapes[] = { "\"\\", "'\\" };
+int ok = 1;
+for (int shape = 0; shape < 2; shape++) {
+    double first = 0.0;
+    for (size_t scale = 1; scale <= 4; scale *= 2) {
+        size_t length = kilobytes * scale * 1024;
+        char *data = malloc(length);
+        if (!data) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < length; i++) data[i] = shapes[shape][i & 1];
+        data[length - 1] = '\n';
+
+        source_buffer_t source;
+        memset(&source, 0, sizeof(source));
+        source.data = data;
+        source.length = length;
+        token_buffer_t tokens = { NULL, 0, 0 };
+        intern_table_t symbols;
+        initInternTable(&symbols);
+        struct timespec start, now;
+        timespec_get(&start, TIME_UTC);
+        if (!lexicalAnalysis(&source, &tokens, &symbols)) exit(EXIT_FAILURE);
+        timespec_get(&now, TIME_UTC);
+        double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+        if (scale == 1) first = seconds;
+
+        // Timer noise dominates below a millisecond
+        int linear = scale < 4 || seconds <= 8.0 * first + 1e-3;
+        ok &= linear;
+        printf("%s x %-8zu  %zu bytes in %.3f s  (%.1f MB/s, %zu tokens)  %s\n", shapes[shape], length / 2, length,
+               seconds, seconds > 0.0 ? (double)length / seconds / 1e6 : 0.0, tokens.count,
+               linear ? "OK" : "NONLINEAR");
+        freeTokens(&tokens);
+        freeInternTable(&symbols);
+        closeSource(&source);
+    }
+}
+if (!ok) exit(EXIT_FAILURE);
+}
 
-fprintf(out, "%-20s | %s\n", "TOKEN", "TYPE");
-fprintf(out, "-------------------------------------\n");
-for (int i = 0; i < token_count; ++i) {
-    fprintf(out, "%-20s | %s\n", tokens[i].text, tokens[i].type);
+// Print a token stream file as the tokens.txt table; returns 0 if it is not
+// a well-formed stream
+static int dumpTokenStream(const char *filename) {
+token_stream_t stream;
+if (!openTokenStream(filename, &stream)) {
+    fprintf(stderr, "Error: '%s' is not a token stream file\n", filename);
+    return 0;
 }
-fclose(out);
+token_stream_cursor_t cursor;
+token_record_t record;
+uint64_t count = 0;
+printf("%-20s | %s\n", "TOKEN", "TYPE");
+printf("-------------------------------------\n");
+tokenStreamBegin(&stream, &cursor);
+while (tokenStreamNext(&cursor, &record)) {
+    size_t length;
+    const char *text = tokenStreamText(&stream, record.string, &length);
+    printf("%-20.*s | %s\n", (int)length, text, token_kind_names[record.kind]);
+    count++;
+}
+int ok = count == stream.header->token_count;
+if (!ok) fprintf(stderr, "Error: '%s' is truncated after %llu tokens\n", filename, (unsigned long long)count);
+closeTokenStream(&stream);
+return ok;
+}
+
+// Lex the file once, then write its tokens `passes` times as the text table
+// and as a binary stream, and read the stream back; report sizes and times
+static void benchOutput(const char *filename, int passes) {
+static const char *format_names[] = { "text", "binary" };
+static const char *output_names[] = { OUTPUT_TOKEN_FILE, OUTPUT_BINARY_FILE };
+source_buffer_t source;
+if (!openSource(filename, 1, &source)) {
+    fprintf(stderr, "Error: cannot open source file '%s'\n", filename);
+    exit(EXIT_FAILURE);
+}
+token_buffer_t tokens = { NULL, 0, 0 };
+intern_table_t symbols;
+initInternTable(&symbols);
+if (!lexicalAnalysis(&source, &tokens, &symbols)) exit(EXIT_FAILURE);
+
+for (int binary = 0; binary <= 1; binary++) {
+    token_writer_t writer;
+    struct timespec start, now;
+    timespec_get(&start, TIME_UTC);
+    for (int pass = 0; pass < passes; pass++) {
+        if (!openTokenWriter(&writer, output_names[binary], &source, &symbols, binary)) exit(EXIT_FAILURE);
+        for (size_t i = 0; i < tokens.count; ++i) writeToken(&writer, &tokens.items[i]);
+        if (!closeTokenWriter(&writer)) exit(EXIT_FAILURE);
+    }
+    timespec_get(&now, TIME_UTC);
+    double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%-7s write  %d passes, %zu tokens in %zu bytes (%.2f bytes/token), %.3f s  (%.1f ns/token)\n",
+           format_names[binary], passes, tokens.count, writer.bytes,
+           tokens.count ? (double)writer.bytes / (double)tokens.count : 0.0, seconds,
+           tokens.count ? seconds * 1e9 / ((double)tokens.count * passes) : 0.0);
+}
+
+// Read back: every record must match the token it came from
+size_t mismatches = 0;
+struct timespec start, now;
+timespec_get(&start, TIME_UTC);
+for (int pass = 0; pass < passes; pass++) {
+    token_stream_t stream;
+    if (!openTokenStream(OUTPUT_BINARY_FILE, &stream)) exit(EXIT_FAILURE);
+    token_stream_cursor_t cursor;
+    token_record_t record;
+    size_t i = 0;
+    tokenStreamBegin(&stream, &cursor);
+    for (; tokenStreamNext(&cursor, &record) && i < tokens.count; ++i) {
+        const token_t *token = &tokens.items[i];
+        size_t length, expected_length;
+        const char *text = tokenStreamText(&stream, record.string, &length);
+        const char *expected = tokenText(&source, &symbols, token, &expected_length);
+        if (record.offset != token->offset || record.line != token->line || record.column != token->column ||
+            record.kind != token->kind || length != expected_length || memcmp(text, expected, length) != 0)
+            mismatches++;
+    }
+    if (i != tokens.count) mismatches++;
+    closeTokenStream(&stream);
+}
+timespec_get(&now, TIME_UTC);
+double seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+printf("binary read   %d passes, %.3f s  (%.1f ns/token)  %s\n", passes, seconds,
+       tokens.count ? seconds * 1e9 / ((double)tokens.count * passes) : 0.0, mismatches ? "MISMATCH" : "OK");
+
+freeTokens(&tokens);
+freeInternTable(&symbols);
+closeSource(&source);
+if (mismatches) exit(EXIT_FAILURE);
 }
@@ -6,6 +6,33 @@ a tiny C-like "program". Each heap object can hold references to other
 objects. The GC performs a mark phase from roots (simulated local variables)
 and a sweep phase to free unreachable objects (including cycles).
 
+Features:
+- Explicit mark stack, so deep object graphs cannot overflow the C stack
+- Mark bits in a side bitmap indexed by pool slot, swept a word at a time
+- Pluggable allocator: size-class arena (default) or malloc
+- Generational mode: nursery, remembered set and write barrier
+- Incremental mode: tri-color marking in slices with an insertion barrier
+- Parallel marking on C11 threads with work-stealing deques
+- Lazy sweeping from allocObject(), and sliding compaction (arena only)
+- A heap that grows on demand, by heap_growth_factor
+- Buffered event log via gc_event_log.h (text, or binary with --binary-log)
+- Heap snapshots in the gc_heap_snapshot.h format
+
+Usage:
+    mark_and_sweep.exe                  Run the tiny program simulation
+    mark_and_sweep.exe --binary-log ... Any mode below, logging binary records instead of text
+    mark_and_sweep.exe --stress [N]     Mark and sweep an N-node chain and a wide fan-out graph
+    mark_and_sweep.exe --bench-alloc [C] Compare alloc/collect cycles per second of both allocators
+    mark_and_sweep.exe --bench-gen [C]   Compare full vs generational pause times
+    mark_and_sweep.exe --bench-incremental [L]  Compare stop-the-world vs incremental pauses (L live objects)
+    mark_and_sweep.exe --bench-parallel [T] [E] Parallel mark scaling from 1 to T threads on an E-edge graph
+    mark_and_sweep.exe --bench-lazy [L]         Compare eager vs lazy sweep pauses (L live objects)
+    mark_and_sweep.exe --bench-compact [L]      Mark time of a fragmented heap before/after compaction
+    mark_and_sweep.exe --bench-grow [N] [F]     Allocate N objects from a 128-slot heap with growth factor F
+    mark_and_sweep.exe --snapshot [N] [T]       Build an N-object sample heap and snapshot it with T threads
+    mark_and_sweep.exe --bench-suite [W] [S] [M] Run gc_bench.h workload W (or all) at scale S in mode M
+                                                (stw, generational, incremental, lazy or parallel) as CSV
+
 For Linux/macOS:
 Replace fopen_s, strcpy_s, etc., with fopen, strcpy, if needed.
 
@@ -23,60 +50,385 @@ Function Definitions
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include <time.h>
+#include "gc_event_log.h"
+#include "gc_heap_snapshot.h"
+#include "gc_bench.h"
 
 //  Constants & Macros
-#define MAX_OBJECTS 128
-#define MAX_REFS_PER_OBJECT 8
-#define MAX_ROOTS 64
+#define HEAP_INITIAL_CAPACITY 128                       //  Slots in the demo heap; it grows on demand
+#define HEAP_GROWTH_FACTOR 2.0                          //  Grown heap size = live objects x factor
+#define REFS_INLINE_CAPACITY 4                          //  refs[] entries stored inside the object
+#define ROOT_STACK_INITIAL_CAPACITY 64
 #define LOG_FILE "marksweep.txt"
+#define LOG_BINARY_FILE "marksweep.gclog"
+#define MARK_STACK_INITIAL_CAPACITY 64
+#define STRESS_DEFAULT_NODES 10000000
+#define STRESS_FAN_OUT 8
+
+#define ARENA_PAGE_SIZE 4096
+#define ARENA_ALIGN 16
+#define ARENA_MAX_SMALL 1024                            //  Larger objects bypass the arena
+#define ARENA_CLASS_COUNT (ARENA_MAX_SMALL / ARENA_ALIGN + 1)
+#define ARENA_LARGE_CLASS 0                             //  size_class of malloc'd oversize objects
+
+#define BENCH_DEFAULT_CYCLES 200
+#define BENCH_OBJECTS_PER_CYCLE 10000
+#define BENCH_CHAIN_LENGTH 8
+#define BENCH_OLD_OBJECTS 100000
+
+#define GEN_MAJOR_THRESHOLD_MIN 1024                    //  Old objects before the first major collection
+#define GEN_MAJOR_GROWTH 2                              //  Next threshold = old live after major x growth
+
+#define INCREMENTAL_SLICE_OBJECTS 256                   //  Max objects scanned per allocObject() slice
+#define INCREMENTAL_SLICE_MICROS 100                    //  Max microseconds per slice
+#define INCREMENTAL_CLOCK_STRIDE 64                     //  Objects scanned between clock reads
+#define BENCH_INCREMENTAL_LIVE 1000000
+#define BENCH_INCREMENTAL_ALLOCS 4000000
+#define LAZY_SWEEP_CHUNK_WORDS 16                       //  Bitmap words (x64 slots) swept per step
+#define BENCH_COMPACT_LIVE 1000000
+#define BENCH_COMPACT_GARBAGE_RATIO 7                   //  Dead objects allocated between live ones
+#define BENCH_COMPACT_MARK_REPEATS 5
+#define WORK_DEQUE_INITIAL_CAPACITY 1024
+#define STEAL_ATTEMPTS 4                                //  Retries when a steal loses a race
+#define BENCH_PARALLEL_THREADS 8
+#define BENCH_PARALLEL_EDGES 50000000
+#define BENCH_PARALLEL_DEGREE 8                         //  Out-edges per node
+#define BENCH_PARALLEL_ROOTS 64
+#define BENCH_GROW_ALLOCS 100000000
+#define BENCH_GROW_BATCH 100000                         //  Children hung off each rooted holder
+#define BENCH_GROW_HOLDERS 10                           //  Holders rooted before all are dropped
+#define BENCH_SUITE_THREADS 4                           //  Mark threads for --bench-suite parallel
+#define SNAPSHOT_FILE "heap.gcsnap"
+#define SNAPSHOT_DEFAULT_OBJECTS 10000000
+#define SNAPSHOT_DEFAULT_THREADS 4
+#define SNAPSHOT_CHAIN_LENGTH 15                        //  Nodes owned by each sample cache entry
+#define SNAPSHOT_INDEX_STRIDE 10                        //  Every Nth entry is also indexed (shared)
+#define SNAPSHOT_GARBAGE_STRIDE 20                      //  Every Nth entry is left unreachable
+#define SNAPSHOT_NAME_TABLE_INITIAL 1024
+#define PAUSE_HISTOGRAM_BUCKETS 24                      //  Bucket b counts pauses in [2^(b-1), 2^b) us
+
+#define REMEMBERED_NONE 0                               //  Not in the remembered set
+#define REMEMBERED_ACTIVE 1                             //  In the set and holds a young reference
+#define REMEMBERED_STALE 2                              //  In the set but its young references were removed
+
+#define BITS_PER_WORD 64
+#define BITMAP_WORDS(slots) (((slots) + BITS_PER_WORD - 1) / BITS_PER_WORD)
+#define BIT_WORD(slot) ((slot) / BITS_PER_WORD)
+#define BIT_MASK(slot) (UINT64_C(1) << ((slot) % BITS_PER_WORD))
+
+//  Hint the CPU to pull an object's cache line in before it is scanned
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(address) __builtin_prefetch((address))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define PREFETCH(address) _mm_prefetch((const char *)(address), _MM_HINT_T0)
+#else
+#define PREFETCH(address) ((void)(address))
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
 
 //  Struct Definitions
 typedef struct ObjectStruct {
-    int marked;                                         //  Mark bit for GC
+    size_t slot;                                        //  Index in objectPool / mark bitmap
     char *name;                                         //  Variable/obj name for logging
     char *value;                                        //   Payload as string
-    struct ObjectStruct *refs[MAX_REFS_PER_OBJECT];     //   Contained references
+    struct ObjectStruct **refs;                         //   Contained references (inline_refs or heap array)
     int ref_count;                                      //   Number of refs held
+    int ref_capacity;                                   //   Entries refs can hold before it grows
+    unsigned char size_class;                           //   Arena free list the object returns to
+    unsigned char remembered;                           //   REMEMBERED_* state for the write barrier
+    struct ObjectStruct *inline_refs[REFS_INLINE_CAPACITY];
 } object_struct_t;
 
+//  Pluggable object allocator: name/value storage is owned by the allocator
+typedef struct ObjectAllocator {
+    const char *label;
+    object_struct_t *(*allocate)(const char *name, const char *value);
+    void (*release)(object_struct_t *object);
+    void (*reset)(void);                                //  Return all backing memory to the system
+} object_allocator_t;
+
+//  Arena pages are chained through a header at the start of each page
+typedef struct ArenaPage {
+    struct ArenaPage *next;
+} arena_page_t;
+
+typedef struct FreeChunk {
+    struct FreeChunk *next;
+} free_chunk_t;
+
+//  One segregated free list plus a bump region per size class
+typedef struct SizeClass {
+    free_chunk_t *free_list;
+    unsigned char *bump;
+    unsigned char *bump_end;
+} size_class_t;
+
+//  Growable stack of object pointers (mark work list, remembered set)
+typedef struct ObjectStack {
+    object_struct_t **items;
+    size_t count;
+    size_t capacity;
+} object_stack_t;
+
+//  Circular array behind a work deque; replaced buffers stay alive until the
+//  mark phase ends because thieves may still be reading them
+typedef struct WorkBuffer {
+    int64_t capacity;
+    _Atomic(object_struct_t *) *slots;
+    struct WorkBuffer *retired_next;
+} work_buffer_t;
+
+//  Chase-Lev deque: the owner pushes/takes at bottom, thieves steal at top
+typedef struct WorkDeque {
+    atomic_llong top;
+    atomic_llong bottom;
+    _Atomic(work_buffer_t *) buffer;
+    work_buffer_t *retired;
+} work_deque_t;
+
+typedef struct MarkWorker {
+    thrd_t thread;
+    int index;
+    int root_begin;                                     //  Slice of roots[] this worker shades
+    int root_end;
+    work_deque_t deque;
+    size_t scanned;
+} mark_worker_t;
+
+//  Columns of a heap snapshot being built (see gc_heap_snapshot.h)
+typedef struct HeapSnapshot {
+    size_t object_count;
+    size_t edge_count;
+    uint32_t *word_rank;                                //  Objects in all earlier bitmap words
+    uint32_t *size;
+    uint32_t *name;                                     //  Name hash during the walk, string id after
+    uint64_t *edge_offset;
+    uint32_t *edge_target;
+    uint32_t *parent;
+} heap_snapshot_t;
+
+//  One thread's range of bitmap words in a snapshot walk phase
+typedef struct SnapshotWorker {
+    thrd_t thread;
+    heap_snapshot_t *snapshot;
+    int phase;
+    size_t word_begin;
+    size_t word_end;
+    size_t first_object;                                //  Id of the range's first object
+    size_t objects;
+    size_t edges;
+} snapshot_worker_t;
+
+//  Pause time totals for one kind of collection
+typedef struct PauseStats {
+    const char *label;
+    size_t count;
+    double total_seconds;
+    double max_seconds;
+} pause_stats_t;
+
 //  Global Variables
-static object_struct_t *objectPool[MAX_OBJECTS];
-static int object_count = 0;
+static object_struct_t **objectPool = NULL;             //  Slot -> object (NULL when free)
+static size_t heap_capacity = 0;                        //  Number of slots in objectPool
+static size_t object_count = 0;                         //  Live (allocated) slots
+static size_t alloc_cursor = 0;                         //  Bitmap word to start the free-slot search at
+static double heap_growth_factor = HEAP_GROWTH_FACTOR;
+
+static uint64_t *live_bits = NULL;                      //  1 = slot holds an allocated object
+static uint64_t *mark_bits = NULL;                      //  1 = slot reached by the current mark phase
+static uint64_t *young_bits = NULL;                     //  1 = slot holds a nursery object
+
+static int generational_mode = 0;
+static int collecting_minor = 0;                        //  Trace young objects only
+static size_t young_count = 0;
+static size_t major_threshold = GEN_MAJOR_THRESHOLD_MIN;
+static object_stack_t remembered_set = { NULL, 0, 0 };  //  Old objects that may point into the nursery
+
+static pause_stats_t full_pauses = { "full", 0, 0.0, 0.0 };
+static pause_stats_t minor_pauses = { "minor", 0, 0.0, 0.0 };
+static pause_stats_t major_pauses = { "major", 0, 0.0, 0.0 };
+static pause_stats_t slice_pauses = { "slice", 0, 0.0, 0.0 };
+static pause_stats_t finish_pauses = { "finish", 0, 0.0, 0.0 };
+static pause_stats_t sweep_pauses = { "sweep", 0, 0.0, 0.0 };
+static size_t pause_histogram[PAUSE_HISTOGRAM_BUCKETS];
 
-static object_struct_t *roots[MAX_OBJECTS];
+static int incremental_mode = 0;
+static int incremental_marking = 0;                     //  An incremental cycle is in progress
+static size_t collection_trigger = 0;                   //  Occupancy that starts an allocation-triggered cycle
+
+static int compaction_mode = 0;
+static int lazy_sweep_mode = 0;
+static int sweep_pending = 0;                           //  Marking finished, sweep not yet complete
+static size_t sweep_cursor = 0;                         //  Next bitmap word the lazy sweep visits
+static size_t lazy_alloc_word = 0;                      //  First swept word that may have a free slot
+
+static int mark_thread_count = 0;                       //  0 = sequential mark, N = parallel mark on N threads
+static mark_worker_t *mark_workers = NULL;
+static atomic_int idle_workers;
+
+static object_struct_t **roots = NULL;
 static int root_count = 0;
+static int root_capacity = 0;
+
+static const char *log_path = LOG_FILE;
+static int log_verbose = 1;                             //  Per-object log lines (off for stress runs)
 
-static FILE *log_file = NULL;
+static arena_page_t *arena_pages = NULL;
+static size_class_t size_classes[ARENA_CLASS_COUNT];
+
+static object_struct_t *mallocAllocate(const char *name, const char *value);
+static void mallocRelease(object_struct_t *object);
+static void mallocReset(void);
+static object_struct_t *arenaAllocate(const char *name, const char *value);
+static void arenaRelease(object_struct_t *object);
+static void arenaReset(void);
+
+static const object_allocator_t malloc_allocator = { "malloc", mallocAllocate, mallocRelease, mallocReset };
+static const object_allocator_t arena_allocator = { "arena", arenaAllocate, arenaRelease, arenaReset };
+static const object_allocator_t *allocator = &arena_allocator;
+
+static object_stack_t mark_stack = { NULL, 0, 0 };      //  Gray objects; replaces recursion
+static size_t objects_marked = 0;                       //  Objects scanned by the last mark phase
 
 //  Function Declarations
 //  Logging
-static void openLogFile(void);
+static void openLogFile(int format);
 static void closeLogFile(void);
 
+//  Heap Management
+static void gcInit(size_t capacity);
+static void gcShutdown(void);
+static size_t findFreeSlot(void);
+static size_t acquireSlot(void);
+static uint64_t *growBitmap(uint64_t *bits, size_t old_words, size_t new_words);
+static void gcGrowHeap(size_t new_capacity);
+static size_t collectOrGrow(void);
+
+//  Allocators
+static void *arenaCarve(size_class_t *size_class, size_t chunk_size);
+
 //  Object Management
 object_struct_t *allocObject(const char *name, const char *value);
 static void addRef(object_struct_t *from, object_struct_t *to);
 static void removeRef(object_struct_t *from, object_struct_t *to);
 static void freeObject(object_struct_t *object);
+static void growRefs(object_struct_t *object);
+static void releaseRefs(object_struct_t *object);
+
+//  Generational Support
+static inline int isYoung(const object_struct_t *object);
+static int holdsYoungRef(const object_struct_t *object);
+static void writeBarrierAdd(object_struct_t *from, object_struct_t *to);
+static void writeBarrierRemove(object_struct_t *from);
+static void forgetRemembered(object_struct_t *object);
+static void markRememberedSet(void);
+static void promoteSurvivors(void);
 
 //  Root Management
 static void pushRoot(object_struct_t *object);
 static void popRoot(void);
 
 //  Mark & Sweep
+static inline int isMarked(const object_struct_t *object);
+static inline void setMarked(const object_struct_t *object);
+static void objectStackPush(object_stack_t *stack, object_struct_t *object);
+static void objectStackFree(object_stack_t *stack);
+static inline void shade(object_struct_t *object);
+static size_t drainMarkStack(size_t max_objects, double max_seconds);
 static void mark(object_struct_t *object);
 static void markAllRoots(void);
+
+//  Parallel Marking
+static inline int tryMarkAtomic(const object_struct_t *object);
+static void dequeInit(work_deque_t *deque);
+static void dequeFree(work_deque_t *deque);
+static void dequePush(work_deque_t *deque, object_struct_t *object);
+static object_struct_t *dequeTake(work_deque_t *deque);
+static object_struct_t *dequeSteal(work_deque_t *deque);
+static object_struct_t *stealWork(mark_worker_t *self);
+static int anyWorkVisible(void);
+static void parallelScan(mark_worker_t *self, object_struct_t *object);
+static int markWorkerMain(void *arg);
+static void parallelMarkRoots(void);
+static void sweepWords(size_t begin, size_t end);
 static void sweep(void);
+static void compactHeap(void);
+static void collectFull(const char *banner, pause_stats_t *stats);
+static void gcMinor(void);
 static void gcCollect(void);
+static void updateCollectionTrigger(void);
+
+//  Incremental Marking
+static void incrementalStart(void);
+static void incrementalStep(void);
+static void incrementalFinish(void);
+
+//  Lazy Sweeping
+static void beginLazySweep(void);
+static size_t lazySweepForSlot(void);
+static void completeLazySweep(void);
+static void finishLazySweep(void);
+
+//  Heap Snapshot
+static size_t objectBytes(const object_struct_t *object);
+static uint32_t hashName(const char *name);
+static inline uint32_t snapshotObjectId(const heap_snapshot_t *snapshot, size_t slot);
+static int snapshotWorkerMain(void *arg);
+static void runSnapshotPhase(snapshot_worker_t *workers, int thread_count, int phase);
+static size_t internSnapshotNames(heap_snapshot_t *snapshot, const char ***strings);
+static void computeRootPaths(heap_snapshot_t *snapshot);
+static int writeHeapSnapshot(const char *path, int thread_count);
+
+//  Pause Statistics
+static void recordPause(pause_stats_t *stats, double seconds);
+static void resetPauseStats(void);
+static void reportPrintf(FILE *out, const char *format, ...);
+static void reportPauses(FILE *out);
+static void reportPauseHistogram(FILE *out);
 
 //  Utility Functions
 static void cleanupAll(void);
 static inline void free_s(void **ptr);
+static inline unsigned countTrailingZeros(uint64_t word);
+static inline unsigned countSetBits(uint64_t word);
+static double elapsedSeconds(const struct timespec *start);
 
 //  Simulation Functions
 static void simulateTinyProgram(void);
 static void simulateCycleEvent(void);
 
+//  Stress Tests
+static void runStressCollect(const char *label, object_struct_t *root, size_t node_count);
+static void stressMarkChain(size_t node_count);
+static void stressMarkFanOut(size_t node_count);
+
+//  Benchmarks
+static double benchAllocCollect(const object_allocator_t *candidate, size_t cycles);
+static void benchGenerational(int generational, size_t cycles);
+static void benchChurn(const char *label, size_t live_objects);
+static void benchParallelMark(int max_threads, size_t edge_count);
+static double benchMarkTime(void);
+static void benchCompaction(size_t live_objects);
+static void benchHeapGrowth(size_t total_allocs);
+static void buildSnapshotHeap(size_t object_count);
+static int setBenchSuiteMode(const char *mode);
+static void *benchSuiteAllocate(const char *name);
+static void benchSuiteLink(void *from, void *to);
+static void benchSuiteUnlink(void *from, void *to);
+static void *benchSuiteChild(void *object, int index);
+static void benchSuitePushRoot(void *object);
+static void benchSuiteRelease(void *object);
+static void benchSuiteCollect(void);
+
 //  Utility Function: (Safe free)
 static inline void free_s(void **ptr) {
     if (ptr && *ptr) {
@@ -85,76 +437,382 @@ static inline void free_s(void **ptr) {
     }
 }
 
+//  Utility Function: index of the lowest set bit (word must be non-zero)
+static inline unsigned countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (unsigned)index;
+#else
+    unsigned index = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+//  Utility Function: number of set bits
+static inline unsigned countSetBits(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (unsigned)__popcnt64(word);
+#else
+    unsigned count = 0;
+    for (; word; word &= word - 1) count++;
+    return count;
+#endif
+}
+
 //  Driver Code
-int main(void) {
+int main(int argc, char **argv) {
     printf("= Mark-and-Sweep GC Simulator =\n");
 
-    openLogFile();
+    int log_format = GC_LOG_FORMAT_TEXT;
+    if (argc >= 2 && strcmp(argv[1], "--binary-log") == 0) {
+        log_format = GC_LOG_FORMAT_BINARY;
+        argc--;
+        argv++;
+    }
+    openLogFile(log_format);
+
+    if (argc >= 2 && strcmp(argv[1], "--stress") == 0) {
+        size_t node_count = STRESS_DEFAULT_NODES;
+        if (argc >= 3) node_count = strtoull(argv[2], NULL, 10);
+        if (node_count < 2) node_count = 2;
+
+        log_verbose = 0;
+        gcInit(node_count);
+        stressMarkChain(node_count);
+        stressMarkFanOut(node_count);
+        gcShutdown();
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-alloc") == 0) {
+        size_t cycles = BENCH_DEFAULT_CYCLES;
+        if (argc >= 3) cycles = strtoull(argv[2], NULL, 10);
+        if (cycles == 0) cycles = 1;
+
+        log_verbose = 0;
+        double malloc_rate = benchAllocCollect(&malloc_allocator, cycles);
+        double arena_rate = benchAllocCollect(&arena_allocator, cycles);
+        printf("arena speedup: %.2fx\n", malloc_rate > 0.0 ? arena_rate / malloc_rate : 0.0);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-gen") == 0) {
+        size_t cycles = BENCH_DEFAULT_CYCLES;
+        if (argc >= 3) cycles = strtoull(argv[2], NULL, 10);
+        if (cycles == 0) cycles = 1;
+
+        log_verbose = 0;
+        benchGenerational(0, cycles);
+        benchGenerational(1, cycles);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-incremental") == 0) {
+        size_t live_objects = BENCH_INCREMENTAL_LIVE;
+        if (argc >= 3) live_objects = strtoull(argv[2], NULL, 10);
+        if (live_objects < 2) live_objects = 2;
+
+        log_verbose = 0;
+        benchChurn("stop-the-world", live_objects);
+        incremental_mode = 1;
+        benchChurn("incremental", live_objects);
+        incremental_mode = 0;
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-lazy") == 0) {
+        size_t live_objects = BENCH_INCREMENTAL_LIVE;
+        if (argc >= 3) live_objects = strtoull(argv[2], NULL, 10);
+        if (live_objects < 2) live_objects = 2;
+
+        log_verbose = 0;
+        benchChurn("eager sweep", live_objects);
+        lazy_sweep_mode = 1;
+        benchChurn("lazy sweep", live_objects);
+        incremental_mode = 1;
+        benchChurn("incremental + lazy sweep", live_objects);
+        incremental_mode = 0;
+        lazy_sweep_mode = 0;
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-parallel") == 0) {
+        int max_threads = BENCH_PARALLEL_THREADS;
+        size_t edge_count = BENCH_PARALLEL_EDGES;
+        if (argc >= 3) max_threads = atoi(argv[2]);
+        if (argc >= 4) edge_count = strtoull(argv[3], NULL, 10);
+        if (max_threads < 1) max_threads = 1;
+
+        log_verbose = 0;
+        benchParallelMark(max_threads, edge_count);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-compact") == 0) {
+        size_t live_objects = BENCH_COMPACT_LIVE;
+        if (argc >= 3) live_objects = strtoull(argv[2], NULL, 10);
+        if (live_objects < 2) live_objects = 2;
+
+        log_verbose = 0;
+        benchCompaction(live_objects);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-grow") == 0) {
+        size_t total_allocs = BENCH_GROW_ALLOCS;
+        if (argc >= 3) total_allocs = strtoull(argv[2], NULL, 10);
+        if (argc >= 4) heap_growth_factor = strtod(argv[3], NULL);
+        if (heap_growth_factor <= 1.0) heap_growth_factor = HEAP_GROWTH_FACTOR;
+
+        log_verbose = 0;
+        benchHeapGrowth(total_allocs);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--snapshot") == 0) {
+        size_t object_count = SNAPSHOT_DEFAULT_OBJECTS;
+        int thread_count = SNAPSHOT_DEFAULT_THREADS;
+        if (argc >= 3) object_count = strtoull(argv[2], NULL, 10);
+        if (argc >= 4) thread_count = atoi(argv[3]);
+        if (thread_count < 1) thread_count = 1;
+
+        log_verbose = 0;
+        gcInit(object_count);
+        buildSnapshotHeap(object_count);
+
+        struct timespec start;
+        timespec_get(&start, TIME_UTC);
+        int ok = writeHeapSnapshot(SNAPSHOT_FILE, thread_count);
+        double seconds = elapsedSeconds(&start);
+        printf("Snapshot of %zu objects written to %s in %.3f s with %d threads\n", object_count, SNAPSHOT_FILE,
+               seconds, thread_count);
+
+        while (root_count > 0) popRoot();
+        gcShutdown();
+        closeLogFile();
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-suite") == 0) {
+        const char *workload = argc >= 3 ? argv[2] : "all";
+        size_t scale = argc >= 4 ? strtoull(argv[3], NULL, 10) : 1;
+        const char *mode = argc >= 5 ? argv[4] : "stw";
+        if (!setBenchSuiteMode(mode)) {
+            fprintf(stderr, "ERROR: Unknown collector mode %s\n", mode);
+            closeLogFile();
+            return EXIT_FAILURE;
+        }
+
+        static const gc_bench_ops_t ops = { "mark-sweep", benchSuiteAllocate, benchSuiteLink, benchSuiteUnlink,
+                                            benchSuiteChild, benchSuitePushRoot, popRoot, benchSuiteRelease,
+                                            benchSuiteCollect };
+        log_verbose = 0;
+        gcInit(HEAP_INITIAL_CAPACITY);
+        int status = gcBenchMain(&ops, workload, scale);
+        gcShutdown();
+        closeLogFile();
+        return status;
+    }
+
+    gcInit(HEAP_INITIAL_CAPACITY);
 
     simulateTinyProgram();
     simulateCycleEvent();
 
     /* Final force-cleanup if anything remains */
-    fprintf(log_file, "\nFinal force-cleanup:\n");
-    cleanupAll();
+    reportPauses(NULL);
+    reportPauseHistogram(NULL);
+    GC_LOG_TEXT("\nFinal force-cleanup:\n");
+    gcShutdown();
 
     closeLogFile();
 
-    printf("Simulation complete. Log written to %s\n", LOG_FILE);
+    printf("Simulation complete. Log written to %s\n", log_path);
     return EXIT_SUCCESS;
 }
 
 //  Logging Functions
-static void openLogFile(void) {
-    errno_t error = fopen_s(&log_file, LOG_FILE, "w");
-    if (error != 0 || log_file == NULL) {
-        fprintf(stderr, "ERROR: Could not open %s for writing.\n", LOG_FILE);
+static void openLogFile(int format) {
+    log_path = format == GC_LOG_FORMAT_BINARY ? LOG_BINARY_FILE : LOG_FILE;
+    if (!gcLogOpen(log_path, format)) {
+        fprintf(stderr, "ERROR: Could not open %s for writing.\n", log_path);
         exit(EXIT_FAILURE);
     }
 }
 
 static void closeLogFile(void) {
-    if (log_file) {
-        fclose(log_file);
-        log_file = NULL;
-    }
+    gcLogClose();
 }
 
-//  Object Management Functions
-object_struct_t *allocObject(const char *name, const char *value) {
-    if (object_count >= MAX_OBJECTS) {
-        fprintf(stderr, "ERROR: Object pool full\n");
+//  Heap Management Functions
+static void gcInit(size_t capacity) {
+    heap_capacity = capacity;
+    object_count = 0;
+    alloc_cursor = 0;
+    objectPool = calloc(capacity, sizeof(*objectPool));
+    live_bits = calloc(BITMAP_WORDS(capacity), sizeof(*live_bits));
+    mark_bits = calloc(BITMAP_WORDS(capacity), sizeof(*mark_bits));
+    young_bits = calloc(BITMAP_WORDS(capacity), sizeof(*young_bits));
+    young_count = 0;
+    major_threshold = GEN_MAJOR_THRESHOLD_MIN;
+    incremental_marking = 0;
+    collection_trigger = capacity / 2;
+    resetPauseStats();
+    if (!objectPool || !live_bits || !mark_bits || !young_bits) {
+        fprintf(stderr, "ERROR: Could not allocate a heap of %zu slots\n", capacity);
         exit(EXIT_FAILURE);
     }
+}
 
-    object_struct_t *object = calloc(1, sizeof(object_struct_t));
-    if (!object) {
-        fprintf(stderr, "ERROR: Memory allocation failed\n");
+static void gcShutdown(void) {
+    incremental_marking = 0;
+    sweep_pending = 0;
+    mark_stack.count = 0;
+    cleanupAll();
+    free_s((void **)&objectPool);
+    free_s((void **)&live_bits);
+    free_s((void **)&mark_bits);
+    free_s((void **)&young_bits);
+    objectStackFree(&mark_stack);
+    objectStackFree(&remembered_set);
+    allocator->reset();
+    heap_capacity = 0;
+    free_s((void **)&roots);
+    root_count = 0;
+    root_capacity = 0;
+}
+
+//  First clear bit in live_bits, starting from the word of the last allocation
+static size_t findFreeSlot(void) {
+    size_t words = BITMAP_WORDS(heap_capacity);
+    for (size_t scanned = 0; scanned < words; scanned++) {
+        size_t w = (alloc_cursor + scanned) % words;
+        uint64_t free_mask = ~live_bits[w];
+        if (free_mask == 0) continue;
+
+        size_t slot = w * BITS_PER_WORD + countTrailingZeros(free_mask);
+        if (slot >= heap_capacity) continue;            //  Padding bits of the last word
+        alloc_cursor = w;
+        return slot;
+    }
+    return SIZE_MAX;
+}
+
+//  A pending lazy sweep hands out slots it has already swept before the
+//  rest of the bitmap is considered
+static size_t acquireSlot(void) {
+    size_t slot = sweep_pending ? lazySweepForSlot() : SIZE_MAX;
+    if (slot == SIZE_MAX && object_count < heap_capacity) slot = findFreeSlot();
+    return slot;
+}
+
+//  Reallocates a bitmap and clears the added words
+static uint64_t *growBitmap(uint64_t *bits, size_t old_words, size_t new_words) {
+    uint64_t *grown = realloc(bits, new_words * sizeof(*grown));
+    if (grown) memset(&grown[old_words], 0, (new_words - old_words) * sizeof(*grown));
+    return grown;
+}
+
+//  Slots keep their indices, so objects, marks and a pending sweep are unaffected
+static void gcGrowHeap(size_t new_capacity) {
+    size_t old_words = BITMAP_WORDS(heap_capacity);
+    size_t new_words = BITMAP_WORDS(new_capacity);
+
+    object_struct_t **pool = realloc(objectPool, new_capacity * sizeof(*pool));
+    if (!pool) {
+        fprintf(stderr, "ERROR: Could not grow the heap to %zu slots\n", new_capacity);
         exit(EXIT_FAILURE);
     }
+    objectPool = pool;
+    memset(&objectPool[heap_capacity], 0, (new_capacity - heap_capacity) * sizeof(*objectPool));
 
-    object->marked = 0;
-    object->name = _strdup(name);
-    object->value = _strdup(value);
-    object->ref_count = 0;
+    uint64_t **bitmaps[] = { &live_bits, &mark_bits, &young_bits };
+    for (size_t i = 0; i < sizeof(bitmaps) / sizeof(bitmaps[0]); i++) {
+        uint64_t *grown = growBitmap(*bitmaps[i], old_words, new_words);
+        if (!grown) {
+            fprintf(stderr, "ERROR: Could not grow the heap to %zu slots\n", new_capacity);
+            exit(EXIT_FAILURE);
+        }
+        *bitmaps[i] = grown;
+    }
+
+    GC_LOG_TEXT("HEAP GROW: %zu -> %zu slots\n", heap_capacity, new_capacity);
+    alloc_cursor = BIT_WORD(heap_capacity);
+    heap_capacity = new_capacity;
+}
+
+//  Pool full: collect before expanding. The heap grows to heap_growth_factor x
+//  the survivors only when they occupy more than 1/heap_growth_factor of it.
+//  Compaction is skipped here because the caller may hold unrooted pointers.
+static size_t collectOrGrow(void) {
+    int compacting = compaction_mode;
+    compaction_mode = 0;
+    gcCollect();
+    compaction_mode = compacting;
+    completeLazySweep();
+
+    size_t target = (size_t)((double)object_count * heap_growth_factor);
+    if (target <= object_count) target = object_count + 1;
+    if (target > heap_capacity) gcGrowHeap(target);
+    updateCollectionTrigger();
+    return acquireSlot();
+}
+
+//  Object Management Functions
+//  May collect first, freeing anything not reachable from a root, so each new
+//  object must be rooted or linked before the next allocObject() call
+object_struct_t *allocObject(const char *name, const char *value) {
+    if (incremental_mode) {
+        if (incremental_marking) incrementalStep();
+        else if (!sweep_pending && object_count >= collection_trigger) incrementalStart();
+    }
+
+    size_t slot = acquireSlot();
+    if (slot == SIZE_MAX) slot = collectOrGrow();
 
-    objectPool[object_count++] = object;
+    object_struct_t *object = allocator->allocate(name, value);
+    object->slot = slot;
+    object->refs = object->inline_refs;
+    object->ref_capacity = REFS_INLINE_CAPACITY;
+
+    objectPool[slot] = object;
+    live_bits[BIT_WORD(slot)] |= BIT_MASK(slot);
+    object_count++;
+    if (generational_mode) {
+        young_bits[BIT_WORD(slot)] |= BIT_MASK(slot);
+        young_count++;
+    }
+    if (incremental_marking) setMarked(object);         //  Allocate black: this cycle's sweep keeps it
 
-    fprintf(log_file, "ALLOC: %s = %s\n", object->name, object->value);
-    fflush(log_file);
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_ALLOC, object->name, object->value, 0);
     return object;
 }
 
 static void addRef(object_struct_t *from, object_struct_t *to) {
     if (!from || !to) return;
-    if (from->ref_count >= MAX_REFS_PER_OBJECT) {
-        fprintf(stderr, "ERROR: too many refs on %s\n", from->name);
-        return;
-    }
+    if (from->ref_count == from->ref_capacity) growRefs(from);
 
     from->refs[from->ref_count++] = to;
-    fprintf(log_file, "ADD_REF: %s -> %s\n", from->name, to->name);
-    fflush(log_file);
+    writeBarrierAdd(from, to);
+    if (incremental_marking) shade(to);                 //  Insertion barrier: no black -> white edges
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_ADD_REF, from->name, to->name, 0);
 }
 
 static void removeRef(object_struct_t *from, object_struct_t *to) {
@@ -163,162 +821,1637 @@ static void removeRef(object_struct_t *from, object_struct_t *to) {
     for (i = 0; i < from->ref_count; i++) {
         if (from->refs[i] == to) break;
     }
-    
+
     if (i == from->ref_count) return;
     for (; i + 1 < from->ref_count; i++) {
         from->refs[i] = from->refs[i + 1];
     }
 
     from->refs[--from->ref_count] = NULL;
-    fprintf(log_file, "REMOVE_REF: %s -/-> %s\n", from->name, to->name);
-    fflush(log_file);
+    writeBarrierRemove(from);
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_REMOVE_REF, from->name, to->name, 0);
 }
 
+//  Releases the object and its pool slot
 static void freeObject(object_struct_t *object) {
     if (!object) return;
-    fprintf(log_file, "FREE: %s (value=%s)\n", object->name, object->value);
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_FREE, object->name, object->value, 0);
+
+    size_t slot = object->slot;
+    objectPool[slot] = NULL;
+    live_bits[BIT_WORD(slot)] &= ~BIT_MASK(slot);
+    object_count--;
+    if (isYoung(object)) {
+        young_bits[BIT_WORD(slot)] &= ~BIT_MASK(slot);
+        young_count--;
+    }
+    if (object->remembered != REMEMBERED_NONE) forgetRemembered(object);
+
+    releaseRefs(object);
+    allocator->release(object);
+}
+
+//  Doubles the reference array, moving it out of the object on first growth
+static void growRefs(object_struct_t *object) {
+    int new_capacity = object->ref_capacity * 2;
+    object_struct_t **refs;
+    if (object->refs == object->inline_refs) {
+        refs = malloc((size_t)new_capacity * sizeof(*refs));
+        if (refs) memcpy(refs, object->inline_refs, sizeof(object->inline_refs));
+    } else {
+        refs = realloc(object->refs, (size_t)new_capacity * sizeof(*refs));
+    }
+    if (!refs) {
+        fprintf(stderr, "ERROR: Could not grow the refs of %s\n", object->name);
+        exit(EXIT_FAILURE);
+    }
+    object->refs = refs;
+    object->ref_capacity = new_capacity;
+}
 
-    for (int i = 0; i < object->ref_count; i++) object->refs[i] = NULL;
+static void releaseRefs(object_struct_t *object) {
+    if (object->refs != object->inline_refs) free(object->refs);
+    object->refs = object->inline_refs;
+    object->ref_capacity = REFS_INLINE_CAPACITY;
     object->ref_count = 0;
+}
+
+//  Generational Support
+static inline int isYoung(const object_struct_t *object) {
+    return (young_bits[BIT_WORD(object->slot)] & BIT_MASK(object->slot)) != 0;
+}
+
+static int holdsYoungRef(const object_struct_t *object) {
+    for (int i = 0; i < object->ref_count; i++) {
+        if (object->refs[i] && isYoung(object->refs[i])) return 1;
+    }
+    return 0;
+}
+
+//  Write barrier: an old -> young edge puts the old object in the remembered set
+static void writeBarrierAdd(object_struct_t *from, object_struct_t *to) {
+    if (!generational_mode || isYoung(from) || !isYoung(to)) return;
+    if (from->remembered == REMEMBERED_NONE) objectStackPush(&remembered_set, from);
+    from->remembered = REMEMBERED_ACTIVE;
+}
+
+//  Write barrier: an old object whose last young reference is removed need not be scanned
+static void writeBarrierRemove(object_struct_t *from) {
+    if (from->remembered == REMEMBERED_ACTIVE && !holdsYoungRef(from)) {
+        from->remembered = REMEMBERED_STALE;
+    }
+}
+
+static void forgetRemembered(object_struct_t *object) {
+    for (size_t i = 0; i < remembered_set.count; i++) {
+        if (remembered_set.items[i] == object) {
+            remembered_set.items[i] = remembered_set.items[--remembered_set.count];
+            break;
+        }
+    }
+    object->remembered = REMEMBERED_NONE;
+}
+
+//  Remembered old objects act as extra roots for the nursery
+static void markRememberedSet(void) {
+    for (size_t i = 0; i < remembered_set.count; i++) {
+        object_struct_t *holder = remembered_set.items[i];
+        if (holder->remembered != REMEMBERED_ACTIVE) continue;
+        for (int r = 0; r < holder->ref_count; r++) {
+            if (holder->refs[r]) mark(holder->refs[r]);
+        }
+    }
+}
+
+//  Every nursery object left after a minor sweep survived: it becomes old, so
+//  no old -> young edges remain and the remembered set empties
+static void promoteSurvivors(void) {
+    memset(young_bits, 0, BITMAP_WORDS(heap_capacity) * sizeof(*young_bits));
+    young_count = 0;
+    for (size_t i = 0; i < remembered_set.count; i++) {
+        remembered_set.items[i]->remembered = REMEMBERED_NONE;
+    }
+    remembered_set.count = 0;
+}
+
+//  Allocator: malloc (one calloc for the object, one _strdup per string)
+static object_struct_t *mallocAllocate(const char *name, const char *value) {
+    object_struct_t *object = calloc(1, sizeof(object_struct_t));
+    if (!object) {
+        fprintf(stderr, "ERROR: Memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    object->name = _strdup(name);
+    object->value = _strdup(value);
+    return object;
+}
+
+static void mallocRelease(object_struct_t *object) {
     free_s((void **)&object->name);
     free_s((void **)&object->value);
     free_s((void **)&object);
 }
 
+static void mallocReset(void) {
+    //  Every object was already returned to malloc by mallocRelease()
+}
+
+//  Allocator: size-class arena (object header followed by inline strings)
+static void *arenaCarve(size_class_t *size_class, size_t chunk_size) {
+    if (size_class->free_list) {
+        free_chunk_t *chunk = size_class->free_list;
+        size_class->free_list = chunk->next;
+        return chunk;
+    }
+
+    if (!size_class->bump || (size_t)(size_class->bump_end - size_class->bump) < chunk_size) {
+        arena_page_t *page = malloc(ARENA_PAGE_SIZE);
+        if (!page) {
+            fprintf(stderr, "ERROR: Arena page allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        page->next = arena_pages;
+        arena_pages = page;
+        size_class->bump = (unsigned char *)page + ARENA_ALIGN;
+        size_class->bump_end = (unsigned char *)page + ARENA_PAGE_SIZE;
+    }
+
+    void *chunk = size_class->bump;
+    size_class->bump += chunk_size;
+    return chunk;
+}
+
+static object_struct_t *arenaAllocate(const char *name, const char *value) {
+    size_t name_length = strlen(name) + 1;
+    size_t value_length = strlen(value) + 1;
+    size_t total = sizeof(object_struct_t) + name_length + value_length;
+    size_t class_index = (total + ARENA_ALIGN - 1) / ARENA_ALIGN;
+
+    object_struct_t *object;
+    if (total > ARENA_MAX_SMALL) {
+        object = malloc(total);
+        if (!object) {
+            fprintf(stderr, "ERROR: Memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        class_index = ARENA_LARGE_CLASS;
+    } else {
+        object = arenaCarve(&size_classes[class_index], class_index * ARENA_ALIGN);
+    }
+
+    memset(object, 0, sizeof(*object));
+    object->size_class = (unsigned char)class_index;
+    object->name = (char *)(object + 1);
+    object->value = object->name + name_length;
+    memcpy(object->name, name, name_length);
+    memcpy(object->value, value, value_length);
+    return object;
+}
+
+static void arenaRelease(object_struct_t *object) {
+    if (object->size_class == ARENA_LARGE_CLASS) {
+        free(object);
+        return;
+    }
+    size_class_t *size_class = &size_classes[object->size_class];
+    free_chunk_t *chunk = (free_chunk_t *)object;
+    chunk->next = size_class->free_list;
+    size_class->free_list = chunk;
+}
+
+static void arenaReset(void) {
+    while (arena_pages) {
+        arena_page_t *next = arena_pages->next;
+        free(arena_pages);
+        arena_pages = next;
+    }
+    memset(size_classes, 0, sizeof(size_classes));
+}
+
 //  Root management (simulate variables / scope)
 static void pushRoot(object_struct_t *object) {
-    if (root_count >= MAX_ROOTS) {
-        fprintf(stderr, "ERROR: root stack overflow\n");
-        exit(EXIT_FAILURE);
+    if (root_count == root_capacity) {
+        int new_capacity = root_capacity ? root_capacity * 2 : ROOT_STACK_INITIAL_CAPACITY;
+        object_struct_t **grown = realloc(roots, (size_t)new_capacity * sizeof(*grown));
+        if (!grown) {
+            fprintf(stderr, "ERROR: Root stack allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+        roots = grown;
+        root_capacity = new_capacity;
     }
     roots[root_count++] = object;
-    fprintf(log_file, "PUSH_ROOT: %s\n", object ? object->name : "(NULL)");
-    fflush(log_file);
+    GC_LOG_PHASE(GC_EVENT_PUSH_ROOT, object ? object->name : "(NULL)", NULL, 0);
 }
 
 static void popRoot(void) {
     if (root_count == 0) return;
     --root_count;
-    fprintf(log_file, "POP_ROOT (now %d roots)\n", root_count);
-    fflush(log_file);
+    GC_LOG_PHASE(GC_EVENT_POP_ROOT, NULL, NULL, root_count);
 }
 
 //  Mark-and-Sweep Implementation
-static void mark(object_struct_t *object) {
-    if (!object) return;
-    if (object->marked) return;
-    object->marked = 1;
-    fprintf(log_file, "MARK: %s\n", object->name);
-    for (int i = 0; i < object->ref_count; ++i) {
-        if (object->refs[i]) mark(object->refs[i]);
-    }
+static inline int isMarked(const object_struct_t *object) {
+    return (mark_bits[BIT_WORD(object->slot)] & BIT_MASK(object->slot)) != 0;
 }
 
-static void markAllRoots(void) {
-    fprintf(log_file, "= MARK PHASE START =\n");
-    for (int i = 0; i < root_count; i++) {
-        if (roots[i]) mark(roots[i]);
-    }
-    fprintf(log_file, "= MARK PHASE END =\n");
-    fflush(log_file);
+static inline void setMarked(const object_struct_t *object) {
+    mark_bits[BIT_WORD(object->slot)] |= BIT_MASK(object->slot);
 }
 
-static void sweep(void) {
-    fprintf(log_file, "= SWEEP PHASE START =\n");
-    int distance = 0;
-    for (int i = 0; i < object_count; i++) {
-        object_struct_t *object = objectPool[i];
-        if (!object) continue;
-        if (object->marked) {
-            object->marked = 0;
-            objectPool[distance++] = 0;
-        } else {
-            freeObject(object);
+static void objectStackPush(object_stack_t *stack, object_struct_t *object) {
+    if (stack->count == stack->capacity) {
+        size_t new_capacity = stack->capacity ? stack->capacity * 2 : MARK_STACK_INITIAL_CAPACITY;
+        object_struct_t **items = realloc(stack->items, new_capacity * sizeof(*items));
+        if (!items) {
+            fprintf(stderr, "ERROR: Object stack allocation failed\n");
+            exit(EXIT_FAILURE);
         }
+        stack->items = items;
+        stack->capacity = new_capacity;
     }
+    stack->items[stack->count++] = object;
+}
 
-    object_count = distance;
-    for (int i = distance; i < MAX_OBJECTS; i++) objectPool[i] = NULL;
-    fprintf(log_file, "= SWEEP PHASE END (object remaining: %d) =\n", object_count);
-    fflush(log_file);
+static void objectStackFree(object_stack_t *stack) {
+    free_s((void **)&stack->items);
+    stack->count = 0;
+    stack->capacity = 0;
 }
 
-static void gcCollect(void) {
-    fprintf(log_file, "\n- GC: Collecting-\n");
-    markAllRoots();
-    sweep();
-    fprintf(log_file, "- GC: Done -\n\n");
-    fflush(log_file);
+//  White -> gray: objects are marked when pushed, so each one enters the
+//  stack at most once. A minor collection treats old objects as live and
+//  never traces into them.
+static inline void shade(object_struct_t *object) {
+    if (!object || isMarked(object)) return;
+    if (collecting_minor && !isYoung(object)) return;
+    setMarked(object);
+    objectStackPush(&mark_stack, object);
 }
 
-//  Cleanup: Free any remaining objects
-static void cleanupAll(void) {
-    for (int i = 0; i < object_count; ++i) {
-        if (objectPool[i]) {
-            freeObject(objectPool[i]);
-            objectPool[i] = NULL;
+//  Gray -> black: scans up to max_objects (and, if max_seconds > 0, for at
+//  most that long). Returns the number of objects scanned.
+static size_t drainMarkStack(size_t max_objects, double max_seconds) {
+    struct timespec start;
+    if (max_seconds > 0.0) timespec_get(&start, TIME_UTC);
+
+    size_t scanned = 0;
+    while (mark_stack.count > 0 && scanned < max_objects) {
+        if (max_seconds > 0.0 && scanned % INCREMENTAL_CLOCK_STRIDE == INCREMENTAL_CLOCK_STRIDE - 1 &&
+            elapsedSeconds(&start) >= max_seconds) break;
+
+        object_struct_t *current = mark_stack.items[--mark_stack.count];
+        if (mark_stack.count > 0) PREFETCH(mark_stack.items[mark_stack.count - 1]);
+
+        scanned++;
+        if (log_verbose) GC_LOG_OBJECT(GC_EVENT_MARK, current->name, NULL, 0);
+
+        //  Push in reverse so children are scanned in declaration order
+        for (int i = current->ref_count - 1; i >= 0; --i) {
+            shade(current->refs[i]);
         }
     }
-    object_count = 0;
+    objects_marked += scanned;
+    return scanned;
 }
 
-//  Simulation of a Tiny "C Program"
-static void simulateTinyProgram(void) {
-    fprintf(log_file, "\n= Simulating tiny program =\n");
-    fprintf(log_file, "int main() {\n");
-    fprintf(log_file, "  int a = 5;\n");
-    fprintf(log_file, "  if (a < 10) { a = a + 1; }\n");
-    fprintf(log_file, "}\n\n");
-
-    //  Simulate: int a = 5; -> allocate object and push as root
-    object_struct_t *a = allocObject("a", "5");
-    pushRoot(a);
-
-    //  Evaluate condition: we might temporarily reference a (simulate)
-    //  no extra root needed here; mark will find it from the root set
+static void mark(object_struct_t *object) {
+    shade(object);
+    drainMarkStack(SIZE_MAX, 0.0);
+}
 
-    //  Simulate 'a = a + 1' -> replace object 'a'
-    //  Remove old value by replacing root with new object
+static void markAllRoots(void) {
+    GC_LOG_TEXT("= MARK PHASE START =\n");
+    objects_marked = 0;
+    if (mark_thread_count > 0 && !collecting_minor) {
+        parallelMarkRoots();
+    } else {
+        for (int i = 0; i < root_count; i++) {
+            if (roots[i]) mark(roots[i]);
+        }
+    }
+    if (collecting_minor) markRememberedSet();
+    GC_LOG_TEXT("= MARK PHASE END (objects marked: %zu) =\n", objects_marked);
+}
 
-    object_struct_t *a_new = allocObject("a", "6");
+//  Parallel Marking
+_Static_assert(sizeof(_Atomic uint64_t) == sizeof(uint64_t), "mark bitmap words must be usable atomically");
 
-    popRoot();
-    pushRoot(a_new);
+//  Returns 1 if this call turned the object's mark bit on
+static inline int tryMarkAtomic(const object_struct_t *object) {
+    _Atomic uint64_t *word = (_Atomic uint64_t *)&mark_bits[BIT_WORD(object->slot)];
+    uint64_t mask = BIT_MASK(object->slot);
+    if (atomic_load_explicit(word, memory_order_relaxed) & mask) return 0;
+    return (atomic_fetch_or_explicit(word, mask, memory_order_relaxed) & mask) == 0;
+}
 
-    popRoot();
+static work_buffer_t *allocWorkBuffer(int64_t capacity) {
+    work_buffer_t *buffer = malloc(sizeof(*buffer));
+    _Atomic(object_struct_t *) *slots = malloc((size_t)capacity * sizeof(*slots));
+    if (!buffer || !slots) {
+        fprintf(stderr, "ERROR: Work deque allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    buffer->capacity = capacity;
+    buffer->slots = slots;
+    buffer->retired_next = NULL;
+    return buffer;
+}
 
-    gcCollect();
+static void dequeInit(work_deque_t *deque) {
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->buffer, allocWorkBuffer(WORK_DEQUE_INITIAL_CAPACITY));
+    deque->retired = NULL;
 }
 
-//  Simulate a scenario with a reference cycle:
-static void simulateCycleEvent(void) {
-    fprintf(log_file, "\n= Simulating cycle example =\n");
-    object_struct_t *root_holder = allocObject("root_holder", "holder");
-    pushRoot(root_holder);
+static void dequeFree(work_deque_t *deque) {
+    work_buffer_t *buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    buffer->retired_next = deque->retired;
+    while (buffer) {
+        work_buffer_t *next = buffer->retired_next;
+        free(buffer->slots);
+        free(buffer);
+        buffer = next;
+    }
+    deque->retired = NULL;
+}
 
-    object_struct_t *x = allocObject("x", "obj_x");
-    object_struct_t *y = allocObject("y", "obj_y");
+//  Owner only
+static void dequePush(work_deque_t *deque, object_struct_t *object) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    work_buffer_t *buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
 
-    //  Make cycle: x -> y, y -> x
-    addRef(x, y);
-    addRef(y, x);
+    if (bottom - top > buffer->capacity - 1) {
+        work_buffer_t *grown = allocWorkBuffer(buffer->capacity * 2);
+        for (int64_t i = top; i < bottom; i++) {
+            object_struct_t *item = atomic_load_explicit(&buffer->slots[i % buffer->capacity], memory_order_relaxed);
+            atomic_store_explicit(&grown->slots[i % grown->capacity], item, memory_order_relaxed);
+        }
+        buffer->retired_next = deque->retired;
+        deque->retired = buffer;
+        atomic_store_explicit(&deque->buffer, grown, memory_order_release);
+        buffer = grown;
+    }
 
-    //  Root_holder points to x and y (so they are reachable)
-    addRef(root_holder, x);
-    addRef(root_holder, y);
+    atomic_store_explicit(&buffer->slots[bottom % buffer->capacity], object, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+}
 
-    //  Run GC: nothing should be collected
-    gcCollect();
+//  Owner only; returns NULL when empty
+static object_struct_t *dequeTake(work_deque_t *deque) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    work_buffer_t *buffer = atomic_load_explicit(&deque->buffer, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
 
-    //  Remove root_holder (simulate going out of scope)
-    popRoot();
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    object_struct_t *object = atomic_load_explicit(&buffer->slots[bottom % buffer->capacity], memory_order_relaxed);
+    if (top == bottom) {
+        //  Last item: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            object = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return object;
+}
+
+//  Any thread; returns NULL when empty or when another thread won the race
+static object_struct_t *dequeSteal(work_deque_t *deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return NULL;
+
+    work_buffer_t *buffer = atomic_load_explicit(&deque->buffer, memory_order_acquire);
+    object_struct_t *object = atomic_load_explicit(&buffer->slots[top % buffer->capacity], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return object;
+}
+
+static object_struct_t *stealWork(mark_worker_t *self) {
+    for (int attempt = 0; attempt < STEAL_ATTEMPTS; attempt++) {
+        for (int offset = 1; offset < mark_thread_count; offset++) {
+            mark_worker_t *victim = &mark_workers[(self->index + offset) % mark_thread_count];
+            object_struct_t *object = dequeSteal(&victim->deque);
+            if (object) return object;
+        }
+    }
+    return NULL;
+}
+
+static int anyWorkVisible(void) {
+    for (int i = 0; i < mark_thread_count; i++) {
+        work_deque_t *deque = &mark_workers[i].deque;
+        if (atomic_load_explicit(&deque->top, memory_order_acquire) <
+            atomic_load_explicit(&deque->bottom, memory_order_acquire)) return 1;
+    }
+    return 0;
+}
+
+static void parallelScan(mark_worker_t *self, object_struct_t *object) {
+    self->scanned++;
+    for (int i = object->ref_count - 1; i >= 0; --i) {
+        object_struct_t *child = object->refs[i];
+        if (child && tryMarkAtomic(child)) {
+            PREFETCH(child);
+            dequePush(&self->deque, child);
+        }
+    }
+}
+
+//  A worker only goes idle with an empty deque and nothing stolen in hand, so
+//  once every worker is idle no gray object is left anywhere
+static int markWorkerMain(void *arg) {
+    mark_worker_t *self = arg;
+    for (int i = self->root_begin; i < self->root_end; i++) {
+        if (roots[i] && tryMarkAtomic(roots[i])) dequePush(&self->deque, roots[i]);
+    }
+
+    for (;;) {
+        object_struct_t *object;
+        while ((object = dequeTake(&self->deque)) != NULL) parallelScan(self, object);
+
+        object = stealWork(self);
+        if (object) {
+            parallelScan(self, object);
+            continue;
+        }
+
+        atomic_fetch_add(&idle_workers, 1);
+        for (;;) {
+            if (atomic_load(&idle_workers) == mark_thread_count) return 0;
+            if (anyWorkVisible()) {
+                atomic_fetch_sub(&idle_workers, 1);
+                break;
+            }
+            thrd_yield();
+        }
+    }
+}
+
+static void parallelMarkRoots(void) {
+    mark_workers = calloc((size_t)mark_thread_count, sizeof(*mark_workers));
+    if (!mark_workers) {
+        fprintf(stderr, "ERROR: Mark worker allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store(&idle_workers, 0);
+
+    for (int i = 0; i < mark_thread_count; i++) {
+        mark_worker_t *worker = &mark_workers[i];
+        worker->index = i;
+        worker->root_begin = root_count * i / mark_thread_count;
+        worker->root_end = root_count * (i + 1) / mark_thread_count;
+        dequeInit(&worker->deque);
+    }
+    for (int i = 0; i < mark_thread_count; i++) {
+        if (thrd_create(&mark_workers[i].thread, markWorkerMain, &mark_workers[i]) != thrd_success) {
+            fprintf(stderr, "ERROR: Could not start mark thread %d\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < mark_thread_count; i++) {
+        thrd_join(mark_workers[i].thread, NULL);
+        objects_marked += mark_workers[i].scanned;
+        dequeFree(&mark_workers[i].deque);
+    }
+
+    free_s((void **)&mark_workers);
+}
+
+//  Dead slots are live & ~marked (restricted to the nursery in a minor
+//  collection); words with no dead bits are skipped whole
+static void sweepWords(size_t begin, size_t end) {
+    for (size_t w = begin; w < end; w++) {
+        uint64_t dead = live_bits[w] & ~mark_bits[w];
+        if (collecting_minor) dead &= young_bits[w];
+        while (dead) {
+            size_t slot = w * BITS_PER_WORD + countTrailingZeros(dead);
+            dead &= dead - 1;
+            freeObject(objectPool[slot]);
+        }
+    }
+}
+
+static void sweep(void) {
+    GC_LOG_TEXT("= SWEEP PHASE START =\n");
+    size_t words = BITMAP_WORDS(heap_capacity);
+
+    sweepWords(0, words);
+    memset(mark_bits, 0, words * sizeof(*mark_bits));
+    GC_LOG_TEXT("= SWEEP PHASE END (object remaining: %zu) =\n", object_count);
+}
+
+//  Sliding compaction with a forwarding table indexed by old slot. Survivors
+//  are copied in slot order into one region; oversize (malloc'd) objects stay
+//  where they are and only get a new slot. Until slots are renumbered every
+//  object still carries its old slot, which is what the table is keyed on.
+static void compactHeap(void) {
+    GC_LOG_TEXT("= COMPACT PHASE START =\n");
+    size_t words = BITMAP_WORDS(heap_capacity);
+
+    size_t region_bytes = ARENA_ALIGN;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t survivors = live_bits[w] & mark_bits[w];
+        while (survivors) {
+            object_struct_t *object = objectPool[w * BITS_PER_WORD + countTrailingZeros(survivors)];
+            survivors &= survivors - 1;
+            if (object->size_class != ARENA_LARGE_CLASS) region_bytes += (size_t)object->size_class * ARENA_ALIGN;
+        }
+    }
+
+    arena_page_t *region = malloc(region_bytes);
+    object_struct_t **forwarding = malloc(heap_capacity * sizeof(*forwarding));
+    if (!region || !forwarding) {
+        fprintf(stderr, "ERROR: Compaction region allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    unsigned char *cursor = (unsigned char *)region + ARENA_ALIGN;
+
+    //  Copy survivors; dead objects vanish with their pages (oversize ones are freed)
+    size_t survivor_count = 0;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t live = live_bits[w];
+        while (live) {
+            size_t slot = w * BITS_PER_WORD + countTrailingZeros(live);
+            live &= live - 1;
+            object_struct_t *object = objectPool[slot];
+
+            if (!(mark_bits[w] & BIT_MASK(slot))) {
+                if (log_verbose) GC_LOG_OBJECT(GC_EVENT_FREE, object->name, object->value, 0);
+                releaseRefs(object);
+                if (object->size_class == ARENA_LARGE_CLASS) free(object);
+                continue;
+            }
+
+            if (object->size_class == ARENA_LARGE_CLASS) {
+                forwarding[slot] = object;
+            } else {
+                size_t chunk_size = (size_t)object->size_class * ARENA_ALIGN;
+                object_struct_t *copy = (object_struct_t *)cursor;
+                memcpy(copy, object, chunk_size);
+                copy->name = (char *)(copy + 1);
+                copy->value = copy->name + (object->value - object->name);
+                if (object->refs == object->inline_refs) copy->refs = copy->inline_refs;
+                cursor += chunk_size;
+                forwarding[slot] = copy;
+            }
+            survivor_count++;
+        }
+    }
+
+    //  Rewrite references; the old copies are still intact at this point
+    for (size_t w = 0; w < words; w++) {
+        uint64_t survivors = live_bits[w] & mark_bits[w];
+        while (survivors) {
+            object_struct_t *copy = forwarding[w * BITS_PER_WORD + countTrailingZeros(survivors)];
+            survivors &= survivors - 1;
+            for (int i = 0; i < copy->ref_count; i++) {
+                if (copy->refs[i]) copy->refs[i] = forwarding[copy->refs[i]->slot];
+            }
+        }
+    }
+    for (int i = 0; i < root_count; i++) {
+        if (roots[i]) roots[i] = forwarding[roots[i]->slot];
+    }
+
+    //  Slide slots down: slot k <= old slot, so objectPool can be rewritten in place
+    size_t next_slot = 0;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t survivors = live_bits[w] & mark_bits[w];
+        while (survivors) {
+            object_struct_t *copy = forwarding[w * BITS_PER_WORD + countTrailingZeros(survivors)];
+            survivors &= survivors - 1;
+            copy->slot = next_slot;
+            copy->remembered = REMEMBERED_NONE;
+            objectPool[next_slot++] = copy;
+        }
+    }
+    memset(&objectPool[next_slot], 0, (heap_capacity - next_slot) * sizeof(*objectPool));
+    memset(live_bits, 0, words * sizeof(*live_bits));
+    for (size_t slot = 0; slot < next_slot; slot++) live_bits[BIT_WORD(slot)] |= BIT_MASK(slot);
+    memset(mark_bits, 0, words * sizeof(*mark_bits));
+
+    //  Survivors are all promoted, so the nursery and remembered set empty
+    memset(young_bits, 0, words * sizeof(*young_bits));
+    young_count = 0;
+    remembered_set.count = 0;
+
+    //  Every small survivor now lives in the region: drop the old pages
+    arenaReset();
+    region->next = NULL;
+    arena_pages = region;
+    free(forwarding);
+
+    object_count = survivor_count;
+    alloc_cursor = 0;
+    GC_LOG_TEXT("= COMPACT PHASE END (object remaining: %zu) =\n", object_count);
+}
+
+static void collectFull(const char *banner, pause_stats_t *stats) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    completeLazySweep();
+    GC_LOG_TEXT("\n- GC: %s -\n", banner);
+    markAllRoots();
+    if (compaction_mode && allocator == &arena_allocator) compactHeap();
+    else if (lazy_sweep_mode) beginLazySweep();
+    else sweep();
+    if (young_count > 0) promoteSurvivors();
+    GC_LOG_TEXT("- GC: Done -\n\n");
+
+    recordPause(stats, elapsedSeconds(&start));
+}
+
+static void gcMinor(void) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    completeLazySweep();
+    GC_LOG_TEXT("\n- GC: Minor collection (young: %zu, remembered: %zu) -\n", young_count, remembered_set.count);
+    collecting_minor = 1;
+    markAllRoots();
+    sweep();
+    collecting_minor = 0;
+    promoteSurvivors();
+    GC_LOG_TEXT("- GC: Done (old generation: %zu) -\n\n", object_count);
+
+    recordPause(&minor_pauses, elapsedSeconds(&start));
+}
+
+static void gcCollect(void) {
+    if (incremental_mode) {
+        if (!incremental_marking) incrementalStart();
+        incrementalFinish();
+        return;
+    }
+    if (!generational_mode) {
+        collectFull("Collecting", &full_pauses);
+        if (!sweep_pending) updateCollectionTrigger();
+        return;
+    }
+
+    gcMinor();
+    if (object_count > major_threshold) {
+        collectFull("Major collection", &major_pauses);
+        size_t next_threshold = object_count * GEN_MAJOR_GROWTH;
+        major_threshold = next_threshold > GEN_MAJOR_THRESHOLD_MIN ? next_threshold : GEN_MAJOR_THRESHOLD_MIN;
+    }
+}
+
+//  Start the next cycle once half of the remaining headroom has been allocated
+static void updateCollectionTrigger(void) {
+    collection_trigger = object_count + (heap_capacity - object_count) / 2;
+}
+
+//  Incremental Marking
+//  Starting a cycle only shades the roots, so it is cheap
+static void incrementalStart(void) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    completeLazySweep();
+    GC_LOG_TEXT("\n- GC: Incremental cycle start (objects: %zu) -\n", object_count);
+    GC_LOG_TEXT("= MARK PHASE START =\n");
+    objects_marked = 0;
+    incremental_marking = 1;
+    for (int i = 0; i < root_count; i++) shade(roots[i]);
+
+    recordPause(&slice_pauses, elapsedSeconds(&start));
+}
+
+static void incrementalStep(void) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    drainMarkStack(INCREMENTAL_SLICE_OBJECTS, INCREMENTAL_SLICE_MICROS / 1e6);
+    int gray_left = mark_stack.count > 0;
+
+    recordPause(&slice_pauses, elapsedSeconds(&start));
+    if (!gray_left) incrementalFinish();
+}
+
+//  Roots carry no barrier, so they are rescanned before the white set is
+//  final; anything still white afterwards is garbage
+static void incrementalFinish(void) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    for (int i = 0; i < root_count; i++) shade(roots[i]);
+    drainMarkStack(SIZE_MAX, 0.0);
+    incremental_marking = 0;
+    GC_LOG_TEXT("= MARK PHASE END (objects marked: %zu) =\n", objects_marked);
+
+    if (lazy_sweep_mode) {
+        beginLazySweep();
+    } else {
+        sweep();
+        updateCollectionTrigger();
+    }
+    GC_LOG_TEXT("- GC: Done -\n\n");
+
+    recordPause(&finish_pauses, elapsedSeconds(&start));
+}
+
+//  Lazy Sweeping
+//  Mark bits stay valid until their word is swept; allocation only uses
+//  swept words, so no object is placed where a stale mark bit could be read
+static void beginLazySweep(void) {
+    GC_LOG_TEXT("= SWEEP PHASE DEFERRED (lazy) =\n");
+    sweep_pending = 1;
+    sweep_cursor = 0;
+    lazy_alloc_word = 0;
+}
+
+//  Sweeps one chunk per call so the sweep finishes well before the free
+//  space runs out, then keeps sweeping until a swept word has a free slot.
+//  Returns SIZE_MAX once the whole bitmap is swept without finding one.
+static size_t lazySweepForSlot(void) {
+    size_t words = BITMAP_WORDS(heap_capacity);
+    struct timespec start;
+    int swept = 0;
+    size_t slot = SIZE_MAX;
+
+    for (;;) {
+        for (; swept && lazy_alloc_word < sweep_cursor; lazy_alloc_word++) {
+            uint64_t free_mask = ~live_bits[lazy_alloc_word];
+            if (free_mask == 0) continue;
+            size_t candidate = lazy_alloc_word * BITS_PER_WORD + countTrailingZeros(free_mask);
+            if (candidate < heap_capacity) {
+                slot = candidate;
+                break;
+            }
+        }
+        if (slot != SIZE_MAX || sweep_cursor >= words) break;
+
+        if (!swept) {
+            timespec_get(&start, TIME_UTC);
+            swept = 1;
+        }
+        size_t end = sweep_cursor + LAZY_SWEEP_CHUNK_WORDS < words ? sweep_cursor + LAZY_SWEEP_CHUNK_WORDS : words;
+        sweepWords(sweep_cursor, end);
+        memset(&mark_bits[sweep_cursor], 0, (end - sweep_cursor) * sizeof(*mark_bits));
+        sweep_cursor = end;
+    }
+
+    if (sweep_cursor >= words) finishLazySweep();
+    if (swept) recordPause(&sweep_pauses, elapsedSeconds(&start));
+    return slot;
+}
+
+static void completeLazySweep(void) {
+    if (!sweep_pending) return;
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+
+    size_t words = BITMAP_WORDS(heap_capacity);
+    sweepWords(sweep_cursor, words);
+    memset(&mark_bits[sweep_cursor], 0, (words - sweep_cursor) * sizeof(*mark_bits));
+    sweep_cursor = words;
+    finishLazySweep();
+
+    recordPause(&sweep_pauses, elapsedSeconds(&start));
+}
+
+static void finishLazySweep(void) {
+    sweep_pending = 0;
+    updateCollectionTrigger();
+    GC_LOG_TEXT("= SWEEP PHASE END (object remaining: %zu) =\n", object_count);
+}
+
+//  Heap Snapshot
+//  Bytes the object occupies in its allocator, including a heap refs array
+static size_t objectBytes(const object_struct_t *object) {
+    size_t bytes = object->size_class != ARENA_LARGE_CLASS
+                 ? (size_t)object->size_class * ARENA_ALIGN
+                 : sizeof(*object) + strlen(object->name) + strlen(object->value) + 2;
+    if (object->refs != object->inline_refs) bytes += (size_t)object->ref_capacity * sizeof(*object->refs);
+    return bytes;
+}
+
+//  FNV-1a, folded to 32 bits
+static uint32_t hashName(const char *name) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (; *name; name++) hash = (hash ^ (unsigned char)*name) * 0x100000001B3ULL;
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+//  Dense id of a live slot: live objects in earlier words plus those below it in its word
+static inline uint32_t snapshotObjectId(const heap_snapshot_t *snapshot, size_t slot) {
+    size_t w = BIT_WORD(slot);
+    return snapshot->word_rank[w] + countSetBits(live_bits[w] & (BIT_MASK(slot) - 1));
+}
+
+//  Phase 0 counts the range's objects; phase 1 ranks its words and records
+//  sizes, name hashes and edge counts; phase 2 fills in the edge targets
+static int snapshotWorkerMain(void *arg) {
+    snapshot_worker_t *self = arg;
+    heap_snapshot_t *snapshot = self->snapshot;
+
+    if (self->phase == 0) {
+        self->objects = 0;
+        for (size_t w = self->word_begin; w < self->word_end; w++) self->objects += countSetBits(live_bits[w]);
+        return 0;
+    }
+
+    size_t id = self->first_object;
+    self->edges = 0;
+    for (size_t w = self->word_begin; w < self->word_end; w++) {
+        if (self->phase == 1) snapshot->word_rank[w] = (uint32_t)id;
+        uint64_t live = live_bits[w];
+        while (live) {
+            object_struct_t *object = objectPool[w * BITS_PER_WORD + countTrailingZeros(live)];
+            live &= live - 1;
+
+            if (self->phase == 1) {
+                size_t bytes = objectBytes(object);
+                snapshot->size[id] = bytes > UINT32_MAX ? UINT32_MAX : (uint32_t)bytes;
+                snapshot->name[id] = hashName(object->name);
+                uint64_t edges = 0;
+                for (int i = 0; i < object->ref_count; i++) edges += object->refs[i] != NULL;
+                snapshot->edge_offset[id + 1] = edges;
+                self->edges += edges;
+            } else {
+                uint64_t edge = snapshot->edge_offset[id];
+                for (int i = 0; i < object->ref_count; i++) {
+                    if (object->refs[i]) snapshot->edge_target[edge++] = snapshotObjectId(snapshot, object->refs[i]->slot);
+                }
+            }
+            id++;
+        }
+    }
+    return 0;
+}
+
+static void runSnapshotPhase(snapshot_worker_t *workers, int thread_count, int phase) {
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].phase = phase;
+        if (thrd_create(&workers[i].thread, snapshotWorkerMain, &workers[i]) != thrd_success) {
+            fprintf(stderr, "ERROR: Could not start snapshot thread %d\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < thread_count; i++) thrd_join(workers[i].thread, NULL);
+}
+
+//  Replaces each name hash with a string id; strings[id] is a name with that id
+static size_t internSnapshotNames(heap_snapshot_t *snapshot, const char ***strings) {
+    size_t table_capacity = SNAPSHOT_NAME_TABLE_INITIAL;
+    size_t string_count = 0;
+    size_t strings_capacity = SNAPSHOT_NAME_TABLE_INITIAL / 2;
+    uint32_t *table = malloc(table_capacity * sizeof(*table));
+    uint32_t *hashes = malloc(strings_capacity * sizeof(*hashes));
+    *strings = malloc(strings_capacity * sizeof(**strings));
+    if (!table || !hashes || !*strings) {
+        fprintf(stderr, "ERROR: Snapshot name table allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(table, 0xFF, table_capacity * sizeof(*table));
+
+    size_t id = 0;
+    for (size_t w = 0; w < BITMAP_WORDS(heap_capacity); w++) {
+        uint64_t live = live_bits[w];
+        while (live) {
+            const char *name = objectPool[w * BITS_PER_WORD + countTrailingZeros(live)]->name;
+            live &= live - 1;
+
+            uint32_t hash = snapshot->name[id];
+            size_t probe = hash & (table_capacity - 1);
+            while (table[probe] != UINT32_MAX &&
+                   (hashes[table[probe]] != hash || strcmp((*strings)[table[probe]], name) != 0)) {
+                probe = (probe + 1) & (table_capacity - 1);
+            }
+
+            if (table[probe] == UINT32_MAX) {
+                if (string_count == strings_capacity) {
+                    //  Keep the table at most half full: double both and rehash
+                    strings_capacity *= 2;
+                    table_capacity *= 2;
+                    hashes = realloc(hashes, strings_capacity * sizeof(*hashes));
+                    *strings = realloc(*strings, strings_capacity * sizeof(**strings));
+                    free(table);
+                    table = malloc(table_capacity * sizeof(*table));
+                    if (!table || !hashes || !*strings) {
+                        fprintf(stderr, "ERROR: Snapshot name table allocation failed\n");
+                        exit(EXIT_FAILURE);
+                    }
+                    memset(table, 0xFF, table_capacity * sizeof(*table));
+                    for (size_t s = 0; s < string_count; s++) {
+                        size_t slot = hashes[s] & (table_capacity - 1);
+                        while (table[slot] != UINT32_MAX) slot = (slot + 1) & (table_capacity - 1);
+                        table[slot] = (uint32_t)s;
+                    }
+                    probe = hash & (table_capacity - 1);
+                    while (table[probe] != UINT32_MAX) probe = (probe + 1) & (table_capacity - 1);
+                }
+                hashes[string_count] = hash;
+                (*strings)[string_count] = name;
+                table[probe] = (uint32_t)string_count++;
+            }
+            snapshot->name[id++] = table[probe];
+        }
+    }
+
+    free(table);
+    free(hashes);
+    return string_count;
+}
+
+//  Breadth-first from the roots, so each parent chain is a shortest root path
+static void computeRootPaths(heap_snapshot_t *snapshot) {
+    uint32_t *queue = malloc((snapshot->object_count + 1) * sizeof(*queue));
+    if (!queue) {
+        fprintf(stderr, "ERROR: Snapshot queue allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(snapshot->parent, 0xFF, snapshot->object_count * sizeof(*snapshot->parent));
+
+    size_t head = 0, tail = 0;
+    for (int i = 0; i < root_count; i++) {
+        if (!roots[i]) continue;
+        uint32_t id = snapshotObjectId(snapshot, roots[i]->slot);
+        if (snapshot->parent[id] != GC_SNAPSHOT_NO_PARENT) continue;
+        snapshot->parent[id] = id;
+        queue[tail++] = id;
+    }
+    while (head < tail) {
+        uint32_t id = queue[head++];
+        for (uint64_t e = snapshot->edge_offset[id]; e < snapshot->edge_offset[id + 1]; e++) {
+            uint32_t target = snapshot->edge_target[e];
+            if (snapshot->parent[target] != GC_SNAPSHOT_NO_PARENT) continue;
+            snapshot->parent[target] = id;
+            queue[tail++] = target;
+        }
+    }
+    free(queue);
+}
+
+//  Completes any pending lazy sweep first so every live slot is a real object.
+//  Returns 0 if the file could not be written.
+static int writeHeapSnapshot(const char *path, int thread_count) {
+    completeLazySweep();
+    if (object_count >= UINT32_MAX) {
+        fprintf(stderr, "ERROR: Heap too large for a snapshot (%zu objects)\n", object_count);
+        return 0;
+    }
+
+    size_t words = BITMAP_WORDS(heap_capacity);
+    heap_snapshot_t snapshot = { 0 };
+    snapshot.object_count = object_count;
+    snapshot.word_rank = malloc((words + 1) * sizeof(*snapshot.word_rank));
+    snapshot.size = malloc((object_count + 1) * sizeof(*snapshot.size));
+    snapshot.name = malloc((object_count + 1) * sizeof(*snapshot.name));
+    snapshot.edge_offset = malloc((object_count + 1) * sizeof(*snapshot.edge_offset));
+    snapshot.parent = malloc((object_count + 1) * sizeof(*snapshot.parent));
+    snapshot_worker_t *workers = calloc((size_t)thread_count, sizeof(*workers));
+    if (!snapshot.word_rank || !snapshot.size || !snapshot.name || !snapshot.edge_offset || !snapshot.parent ||
+        !workers) {
+        fprintf(stderr, "ERROR: Snapshot allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].snapshot = &snapshot;
+        workers[i].word_begin = words * (size_t)i / (size_t)thread_count;
+        workers[i].word_end = words * (size_t)(i + 1) / (size_t)thread_count;
+    }
+    runSnapshotPhase(workers, thread_count, 0);
+    size_t first_object = 0;
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].first_object = first_object;
+        first_object += workers[i].objects;
+    }
+
+    snapshot.edge_offset[0] = 0;
+    runSnapshotPhase(workers, thread_count, 1);
+    for (size_t id = 0; id < object_count; id++) snapshot.edge_offset[id + 1] += snapshot.edge_offset[id];
+    snapshot.edge_count = (size_t)snapshot.edge_offset[object_count];
+    snapshot.edge_target = malloc((snapshot.edge_count + 1) * sizeof(*snapshot.edge_target));
+    if (!snapshot.edge_target) {
+        fprintf(stderr, "ERROR: Snapshot allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    runSnapshotPhase(workers, thread_count, 2);
+
+    const char **strings = NULL;
+    size_t string_count = internSnapshotNames(&snapshot, &strings);
+    computeRootPaths(&snapshot);
+
+    uint32_t *root_ids = malloc(((size_t)root_count + 1) * sizeof(*root_ids));
+    uint64_t *string_offsets = malloc((string_count + 1) * sizeof(*string_offsets));
+    if (!root_ids || !string_offsets) {
+        fprintf(stderr, "ERROR: Snapshot allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t root_ids_count = 0;
+    for (int i = 0; i < root_count; i++) {
+        if (roots[i]) root_ids[root_ids_count++] = snapshotObjectId(&snapshot, roots[i]->slot);
+    }
+    string_offsets[0] = 0;
+    for (size_t i = 0; i < string_count; i++) string_offsets[i + 1] = string_offsets[i] + strlen(strings[i]);
+
+    gc_snapshot_header_t header = { GC_SNAPSHOT_MAGIC, object_count, snapshot.edge_count, root_ids_count,
+                                    string_count, string_offsets[string_count] };
+    FILE *out = NULL;
+    errno_t error = fopen_s(&out, path, "wb");
+    int ok = error == 0 && out != NULL;
+    if (ok) {
+        fwrite(&header, sizeof(header), 1, out);
+        fwrite(snapshot.size, sizeof(*snapshot.size), object_count, out);
+        fwrite(snapshot.name, sizeof(*snapshot.name), object_count, out);
+        fwrite(snapshot.edge_offset, sizeof(*snapshot.edge_offset), object_count + 1, out);
+        fwrite(snapshot.edge_target, sizeof(*snapshot.edge_target), snapshot.edge_count, out);
+        fwrite(root_ids, sizeof(*root_ids), root_ids_count, out);
+        fwrite(snapshot.parent, sizeof(*snapshot.parent), object_count, out);
+        fwrite(string_offsets, sizeof(*string_offsets), string_count + 1, out);
+        for (size_t i = 0; i < string_count; i++) fwrite(strings[i], 1, strlen(strings[i]), out);
+        ok = !ferror(out);
+        ok = fclose(out) == 0 && ok;
+    }
+    if (!ok) fprintf(stderr, "ERROR: Could not write heap snapshot %s\n", path);
+    else GC_LOG_TEXT("HEAP SNAPSHOT: %s (%zu objects, %zu edges)\n", path, object_count, snapshot.edge_count);
+
+    free(root_ids);
+    free(string_offsets);
+    free(strings);
+    free(workers);
+    free(snapshot.word_rank);
+    free(snapshot.size);
+    free(snapshot.name);
+    free(snapshot.edge_offset);
+    free(snapshot.edge_target);
+    free(snapshot.parent);
+    return ok;
+}
+
+//  Pause Statistics
+//  Every recorded pause is also a mutator pause for the latency histogram
+static void recordPause(pause_stats_t *stats, double seconds) {
+    stats->count++;
+    stats->total_seconds += seconds;
+    if (seconds > stats->max_seconds) stats->max_seconds = seconds;
+    gcBenchRecordPause(seconds);
+
+    size_t bucket = 0;
+    for (double micros = seconds * 1e6; micros >= 1.0 && bucket + 1 < PAUSE_HISTOGRAM_BUCKETS; micros /= 2.0) {
+        bucket++;
+    }
+    pause_histogram[bucket]++;
+}
+
+static void resetPauseStats(void) {
+    pause_stats_t *all[] = { &full_pauses, &minor_pauses, &major_pauses, &slice_pauses, &finish_pauses, &sweep_pauses };
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        all[i]->count = 0;
+        all[i]->total_seconds = 0.0;
+        all[i]->max_seconds = 0.0;
+    }
+    memset(pause_histogram, 0, sizeof(pause_histogram));
+}
+
+//  out == NULL sends the report to the event log
+static void reportPrintf(FILE *out, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (out) vfprintf(out, format, args);
+    else gcLogVText(format, args);
+    va_end(args);
+}
+
+static void reportPauseHistogram(FILE *out) {
+    size_t total = 0;
+    for (size_t b = 0; b < PAUSE_HISTOGRAM_BUCKETS; b++) total += pause_histogram[b];
+    if (total == 0) return;
+
+    reportPrintf(out, "%-22s %10s %8s\n", "pause (us)", "count", "share");
+    for (size_t b = 0; b < PAUSE_HISTOGRAM_BUCKETS; b++) {
+        if (pause_histogram[b] == 0) continue;
+        unsigned long long low = b == 0 ? 0 : 1ULL << (b - 1);
+        char range[32];
+        if (b + 1 == PAUSE_HISTOGRAM_BUCKETS) snprintf(range, sizeof(range), ">= %llu", low);
+        else snprintf(range, sizeof(range), "[%llu, %llu)", low, 1ULL << b);
+        reportPrintf(out, "%-22s %10zu %7.2f%%\n", range, pause_histogram[b],
+                     100.0 * (double)pause_histogram[b] / (double)total);
+    }
+}
+
+static void reportPauses(FILE *out) {
+    const pause_stats_t *all[] = { &full_pauses, &minor_pauses, &major_pauses, &slice_pauses, &finish_pauses, &sweep_pauses };
+    reportPrintf(out, "%-6s %8s %12s %12s %12s\n", "kind", "count", "total ms", "avg ms", "max ms");
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        const pause_stats_t *stats = all[i];
+        if (stats->count == 0) continue;
+        reportPrintf(out, "%-6s %8zu %12.3f %12.4f %12.4f\n", stats->label, stats->count,
+                     stats->total_seconds * 1e3, stats->total_seconds * 1e3 / (double)stats->count,
+                     stats->max_seconds * 1e3);
+    }
+}
+
+//  Cleanup: Free any remaining objects
+static void cleanupAll(void) {
+    if (!objectPool) return;
+    for (size_t w = 0; w < BITMAP_WORDS(heap_capacity); w++) {
+        uint64_t live = live_bits[w];
+        while (live) {
+            size_t slot = w * BITS_PER_WORD + countTrailingZeros(live);
+            live &= live - 1;
+            freeObject(objectPool[slot]);
+        }
+    }
+    object_count = 0;
+}
+
+static double elapsedSeconds(const struct timespec *start) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//  Simulation of a Tiny "C Program"
+static void simulateTinyProgram(void) {
+    GC_LOG_TEXT("\n= Simulating tiny program =\n");
+    GC_LOG_TEXT("int main() {\n");
+    GC_LOG_TEXT("  int a = 5;\n");
+    GC_LOG_TEXT("  if (a < 10) { a = a + 1; }\n");
+    GC_LOG_TEXT("}\n\n");
+
+    //  Simulate: int a = 5; -> allocate object and push as root
+    object_struct_t *a = allocObject("a", "5");
+    pushRoot(a);
+
+    //  Evaluate condition: we might temporarily reference a (simulate)
+    //  no extra root needed here; mark will find it from the root set
+
+    //  Simulate 'a = a + 1' -> replace object 'a'
+    //  Remove old value by replacing root with new object
+
+    object_struct_t *a_new = allocObject("a", "6");
+
+    popRoot();
+    pushRoot(a_new);
+
+    popRoot();
+
+    gcCollect();
+}
+
+//  Simulate a scenario with a reference cycle:
+static void simulateCycleEvent(void) {
+    GC_LOG_TEXT("\n= Simulating cycle example =\n");
+    object_struct_t *root_holder = allocObject("root_holder", "holder");
+    pushRoot(root_holder);
+
+    object_struct_t *x = allocObject("x", "obj_x");
+    object_struct_t *y = allocObject("y", "obj_y");
+
+    //  Make cycle: x -> y, y -> x
+    addRef(x, y);
+    addRef(y, x);
+
+    //  Root_holder points to x and y (so they are reachable)
+    addRef(root_holder, x);
+    addRef(root_holder, y);
+
+    //  Run GC: nothing should be collected
+    gcCollect();
+
+    //  Drop the direct edge to y: y is still reachable through x, so it survives
+    removeRef(root_holder, y);
+    gcCollect();
+
+    //  Remove root_holder (simulate going out of scope)
+    popRoot();
 
     //  Now x and y are reachable only from each other (cycle). mark phase should NOT mark them.
     gcCollect();
 
-    removeRef(x, y);
-    removeRef(y, x);    
+    //  x and y were reclaimed by the collection above, so their pointers are
+    //  dangling now and must not be used again
 
     //  Clean any leftover objects
     gcCollect();    //  Safe to call again
 }
+
+//  Stress Tests
+//  Marks and sweeps the graph while rooted (sweep frees nothing), then drops
+//  the root so the second sweep reclaims every node.
+static void runStressCollect(const char *label, object_struct_t *root, size_t node_count) {
+    struct timespec start;
+    GC_LOG_TEXT("\n= Stress: %s (%zu nodes) =\n", label, node_count);
+
+    pushRoot(root);
+    timespec_get(&start, TIME_UTC);
+    markAllRoots();
+    double mark_seconds = elapsedSeconds(&start);
+    size_t marked = objects_marked;
+
+    timespec_get(&start, TIME_UTC);
+    sweep();
+    double sweep_seconds = elapsedSeconds(&start);
+    size_t survivors = object_count;
+
+    popRoot();
+    timespec_get(&start, TIME_UTC);
+    gcCollect();
+    double reclaim_seconds = elapsedSeconds(&start);
+
+    int ok = marked == node_count && survivors == node_count && object_count == 0;
+    printf("%-8s %10zu nodes  mark %8.3f s (%12.0f objects/sec)  live sweep %8.4f s  reclaim %8.3f s  %s\n",
+           label, node_count, mark_seconds,
+           mark_seconds > 0.0 ? (double)marked / mark_seconds : 0.0,
+           sweep_seconds, reclaim_seconds, ok ? "OK" : "FAILED");
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  A single linked list: recursion depth would equal node_count
+static void stressMarkChain(size_t node_count) {
+    object_struct_t *head = allocObject("chain", "");
+    object_struct_t *tail = head;
+    for (size_t i = 1; i < node_count; i++) {
+        object_struct_t *node = allocObject("chain", "");
+        addRef(tail, node);
+        tail = node;
+    }
+    runStressCollect("chain", head, node_count);
+}
+
+//  A complete STRESS_FAN_OUT-ary tree
+static void stressMarkFanOut(size_t node_count) {
+    object_struct_t **nodes = malloc(node_count * sizeof(*nodes));
+    if (!nodes) {
+        fprintf(stderr, "ERROR: Could not allocate %zu stress nodes\n", node_count);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < node_count; i++) {
+        nodes[i] = allocObject("fanout", "");
+        if (i > 0) addRef(nodes[(i - 1) / STRESS_FAN_OUT], nodes[i]);
+    }
+    object_struct_t *root = nodes[0];
+    free(nodes);
+    runStressCollect("fan-out", root, node_count);
+}
+
+//  Benchmarks
+//  Each cycle allocates short chains, keeps only the first chain rooted, and
+//  collects; nearly every object dies young, so the allocator dominates.
+static double benchAllocCollect(const object_allocator_t *candidate, size_t cycles) {
+    struct timespec start;
+    allocator = candidate;
+    gcInit(2 * BENCH_OBJECTS_PER_CYCLE);
+
+    timespec_get(&start, TIME_UTC);
+    for (size_t cycle = 0; cycle < cycles; cycle++) {
+        if (root_count > 0) popRoot();
+
+        object_struct_t *previous = NULL;
+        for (size_t i = 0; i < BENCH_OBJECTS_PER_CYCLE; i++) {
+            object_struct_t *object = allocObject("bench_object", "payload");
+            if (i % BENCH_CHAIN_LENGTH != 0) addRef(previous, object);
+            else if (i == 0) pushRoot(object);
+            previous = object;
+        }
+        gcCollect();
+    }
+    double seconds = elapsedSeconds(&start);
+
+    if (root_count > 0) popRoot();
+    gcShutdown();
+
+    double rate = seconds > 0.0 ? (double)cycles / seconds : 0.0;
+    printf("%-8s %6zu cycles x %d objects  %8.3f s  %10.1f cycles/sec\n",
+           candidate->label, cycles, BENCH_OBJECTS_PER_CYCLE, seconds, rate);
+    return rate;
+}
+
+//  A long-lived chain of BENCH_OLD_OBJECTS plus mostly short-lived garbage.
+//  Each cycle also hangs one young chain off a random old node (exercising the
+//  write barrier) and drops the chain stored there before, creating old garbage.
+static void benchGenerational(int generational, size_t cycles) {
+    struct timespec start;
+    generational_mode = generational;
+    gcInit(2 * BENCH_OLD_OBJECTS + 2 * BENCH_OBJECTS_PER_CYCLE);
+
+    object_struct_t **old_nodes = malloc(BENCH_OLD_OBJECTS * sizeof(*old_nodes));
+    if (!old_nodes) {
+        fprintf(stderr, "ERROR: Could not allocate benchmark nodes\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < BENCH_OLD_OBJECTS; i++) {
+        old_nodes[i] = allocObject("old", "long_lived");
+        if (i > 0) addRef(old_nodes[i - 1], old_nodes[i]);
+    }
+    pushRoot(old_nodes[0]);
+    gcCollect();
+    resetPauseStats();
+
+    timespec_get(&start, TIME_UTC);
+    for (size_t cycle = 0; cycle < cycles; cycle++) {
+        object_struct_t *holder = old_nodes[(cycle * 7919) % BENCH_OLD_OBJECTS];
+        if (holder->ref_count > 1) removeRef(holder, holder->refs[1]);
+
+        object_struct_t *previous = NULL;
+        for (size_t i = 0; i < BENCH_OBJECTS_PER_CYCLE; i++) {
+            object_struct_t *object = allocObject("young", "short_lived");
+            if (i % BENCH_CHAIN_LENGTH != 0) addRef(previous, object);
+            else if (i == 0) addRef(holder, object);
+            previous = object;
+        }
+        gcCollect();
+    }
+    double seconds = elapsedSeconds(&start);
+
+    printf("\n%s collector: %zu cycles in %.3f s\n", generational ? "generational" : "full", cycles, seconds);
+    reportPauses(stdout);
+
+    popRoot();
+    free(old_nodes);
+    gcShutdown();
+    generational_mode = 0;
+}
+
+//  A long-lived chain of live_objects plus BENCH_INCREMENTAL_ALLOCS objects of
+//  short-lived garbage, run under whichever collector modes are set; every
+//  1000th garbage chain is hung off a live node so the insertion barrier sees
+//  stores during marking. Without incremental mode the benchmark collects at
+//  the same trigger an incremental cycle would start marking at.
+static void benchChurn(const char *label, size_t live_objects) {
+    struct timespec start;
+    gcInit(2 * live_objects + 2 * BENCH_OBJECTS_PER_CYCLE);
+
+    object_struct_t *head = allocObject("live", "long_lived");
+    object_struct_t *tail = head;
+    pushRoot(head);
+    for (size_t i = 1; i < live_objects; i++) {
+        object_struct_t *node = allocObject("live", "long_lived");
+        addRef(tail, node);
+        tail = node;
+    }
+    gcCollect();
+    resetPauseStats();
+
+    timespec_get(&start, TIME_UTC);
+    object_struct_t *previous = NULL;
+    for (size_t i = 0; i < BENCH_INCREMENTAL_ALLOCS; i++) {
+        if (!incremental_mode && !sweep_pending && object_count >= collection_trigger) gcCollect();
+
+        object_struct_t *object = allocObject("garbage", "short_lived");
+        if (i % BENCH_CHAIN_LENGTH != 0) {
+            addRef(previous, object);
+        } else if (i % (1000 * BENCH_CHAIN_LENGTH) == 0) {
+            if (head->ref_count > 1) removeRef(head, head->refs[1]);
+            addRef(head, object);
+        }
+        previous = object;
+    }
+    double seconds = elapsedSeconds(&start);
+
+    printf("\n%s: %d allocations over a %zu-object live heap in %.3f s\n",
+           label, BENCH_INCREMENTAL_ALLOCS, live_objects, seconds);
+    reportPauses(stdout);
+    reportPauseHistogram(stdout);
+
+    popRoot();
+    gcShutdown();
+}
+
+//  Random graph with BENCH_PARALLEL_DEGREE out-edges per node, rooted at the
+//  first BENCH_PARALLEL_ROOTS nodes. Marks it sequentially, then with 1, 2, 4, ...
+//  max_threads workers, clearing the mark bitmap between runs.
+static void benchParallelMark(int max_threads, size_t edge_count) {
+    size_t node_count = edge_count / BENCH_PARALLEL_DEGREE;
+    if (node_count < BENCH_PARALLEL_ROOTS) node_count = BENCH_PARALLEL_ROOTS;
+    gcInit(node_count);
+
+    object_struct_t **nodes = malloc(node_count * sizeof(*nodes));
+    if (!nodes) {
+        fprintf(stderr, "ERROR: Could not allocate benchmark nodes\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < node_count; i++) nodes[i] = allocObject("n", "");
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < node_count; i++) {
+        for (int r = 0; r < BENCH_PARALLEL_DEGREE; r++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            addRef(nodes[i], nodes[state % node_count]);
+        }
+    }
+    for (int i = 0; i < BENCH_PARALLEL_ROOTS; i++) pushRoot(nodes[i]);
+    free(nodes);
+
+    printf("Parallel mark: %zu objects, %zu edges\n", node_count, node_count * BENCH_PARALLEL_DEGREE);
+    printf("%-10s %10s %12s %16s %8s\n", "threads", "seconds", "marked", "objects/sec", "speedup");
+
+    double baseline = 0.0;
+    int threads = 0;
+    for (;;) {
+        mark_thread_count = threads;
+        memset(mark_bits, 0, BITMAP_WORDS(heap_capacity) * sizeof(*mark_bits));
+
+        struct timespec start;
+        timespec_get(&start, TIME_UTC);
+        markAllRoots();
+        double seconds = elapsedSeconds(&start);
+        if (threads == 0) baseline = seconds;
+
+        char label[16];
+        if (threads == 0) snprintf(label, sizeof(label), "sequential");
+        else snprintf(label, sizeof(label), "%d", threads);
+        printf("%-10s %10.3f %12zu %16.0f %7.2fx\n", label, seconds, objects_marked,
+               seconds > 0.0 ? (double)objects_marked / seconds : 0.0,
+               seconds > 0.0 ? baseline / seconds : 0.0);
+        if (threads == max_threads) break;
+        threads = threads == 0 ? 1 : threads * 2;
+        if (threads > max_threads) threads = max_threads;
+    }
+
+    mark_thread_count = 0;
+    memset(mark_bits, 0, BITMAP_WORDS(heap_capacity) * sizeof(*mark_bits));
+    while (root_count > 0) popRoot();
+    gcShutdown();
+}
+
+//  Best of BENCH_COMPACT_MARK_REPEATS full marks over the current heap
+static double benchMarkTime(void) {
+    double best = 0.0;
+    for (int repeat = 0; repeat < BENCH_COMPACT_MARK_REPEATS; repeat++) {
+        memset(mark_bits, 0, BITMAP_WORDS(heap_capacity) * sizeof(*mark_bits));
+        struct timespec start;
+        timespec_get(&start, TIME_UTC);
+        markAllRoots();
+        double seconds = elapsedSeconds(&start);
+        if (repeat == 0 || seconds < best) best = seconds;
+    }
+    memset(mark_bits, 0, BITMAP_WORDS(heap_capacity) * sizeof(*mark_bits));
+    return best;
+}
+
+//  A live chain allocated with BENCH_COMPACT_GARBAGE_RATIO dead objects of the
+//  same size class between consecutive nodes. After the sweep the survivors
+//  are spread across many arena pages; compaction packs them back together.
+static void benchCompaction(size_t live_objects) {
+    gcInit(live_objects * (BENCH_COMPACT_GARBAGE_RATIO + 1));
+
+    object_struct_t *head = allocObject("live", "payload");
+    object_struct_t *tail = head;
+    pushRoot(head);
+    for (size_t i = 1; i < live_objects; i++) {
+        for (int g = 0; g < BENCH_COMPACT_GARBAGE_RATIO; g++) allocObject("dead", "payload");
+        object_struct_t *node = allocObject("live", "payload");
+        addRef(tail, node);
+        tail = node;
+    }
+    gcCollect();
+
+    double before = benchMarkTime();
+    size_t marked = objects_marked;
+
+    compaction_mode = 1;
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    gcCollect();
+    double compact_seconds = elapsedSeconds(&start);
+    compaction_mode = 0;
+
+    double after = benchMarkTime();
+    int ok = marked == live_objects && objects_marked == live_objects && object_count == live_objects;
+
+    printf("Compaction: %zu live objects, %d dead between each\n", live_objects, BENCH_COMPACT_GARBAGE_RATIO);
+    printf("mark before compaction %8.3f ms  (%12.0f objects/sec)\n", before * 1e3,
+           before > 0.0 ? (double)marked / before : 0.0);
+    printf("compacting collection  %8.3f ms\n", compact_seconds * 1e3);
+    printf("mark after compaction  %8.3f ms  (%12.0f objects/sec)  speedup %.2fx  %s\n", after * 1e3,
+           after > 0.0 ? (double)objects_marked / after : 0.0, after > 0.0 ? before / after : 0.0,
+           ok ? "OK" : "FAILED");
+
+    popRoot();
+    gcShutdown();
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  Starts from a HEAP_INITIAL_CAPACITY-slot heap and never collects explicitly:
+//  every collection and every growth step comes from a full pool. Each rooted
+//  holder collects BENCH_GROW_BATCH children in its (growing) refs array; once
+//  BENCH_GROW_HOLDERS are rooted they are all dropped.
+static void benchHeapGrowth(size_t total_allocs) {
+    struct timespec start;
+    gcInit(HEAP_INITIAL_CAPACITY);
+
+    size_t peak_live = 0;
+    size_t allocated = 0;
+    timespec_get(&start, TIME_UTC);
+    while (allocated < total_allocs) {
+        object_struct_t *holder = allocObject("holder", "payload");
+        pushRoot(holder);
+        allocated++;
+        for (size_t i = 0; i < BENCH_GROW_BATCH && allocated < total_allocs; i++, allocated++) {
+            addRef(holder, allocObject("child", "payload"));
+        }
+        if (object_count > peak_live) peak_live = object_count;
+        if (root_count == BENCH_GROW_HOLDERS) {
+            while (root_count > 0) popRoot();
+        }
+    }
+    double seconds = elapsedSeconds(&start);
+    size_t collections = full_pauses.count;
+
+    while (root_count > 0) popRoot();
+    gcCollect();
+    completeLazySweep();
+    int ok = object_count == 0;
+
+    printf("Heap growth: %zu allocations in %.3f s  (%.0f allocations/sec)  %s\n", allocated, seconds,
+           seconds > 0.0 ? (double)allocated / seconds : 0.0, ok ? "OK" : "FAILED");
+    printf("growth factor %.2f, final heap %zu slots, peak occupancy %zu, %zu collections\n",
+           heap_growth_factor, heap_capacity, peak_live, collections);
+    reportPauses(stdout);
+
+    gcShutdown();
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  Sample heap for --snapshot: a rooted cache of entries that each own a
+//  chain of SNAPSHOT_CHAIN_LENGTH nodes with varying payload sizes, an index
+//  root that shares every SNAPSHOT_INDEX_STRIDE-th entry, and unreachable
+//  entries that a collection has not reclaimed yet.
+static void buildSnapshotHeap(size_t object_count) {
+    static const char payload[] = "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+    object_struct_t *cache = allocObject("cache", "");
+    object_struct_t *index = allocObject("index", "");
+    pushRoot(cache);
+    pushRoot(index);
+
+    size_t allocated = 2;
+    for (size_t entry_number = 0; allocated < object_count; entry_number++) {
+        object_struct_t *entry = allocObject("entry", payload + entry_number % 48);
+        allocated++;
+        if (entry_number % SNAPSHOT_GARBAGE_STRIDE != SNAPSHOT_GARBAGE_STRIDE - 1) addRef(cache, entry);
+        if (entry_number % SNAPSHOT_INDEX_STRIDE == 0) addRef(index, entry);
+
+        object_struct_t *tail = entry;
+        for (int i = 0; i < SNAPSHOT_CHAIN_LENGTH && allocated < object_count; i++, allocated++) {
+            object_struct_t *node = allocObject("node", payload + (entry_number + (size_t)i) % 64);
+            addRef(tail, node);
+            tail = node;
+        }
+    }
+}
+
+//  --bench-suite: the collector configuration the gc_bench.h workloads run under
+static int setBenchSuiteMode(const char *mode) {
+    if (strcmp(mode, "stw") == 0) return 1;
+    if (strcmp(mode, "generational") == 0) generational_mode = 1;
+    else if (strcmp(mode, "incremental") == 0) incremental_mode = 1;
+    else if (strcmp(mode, "lazy") == 0) lazy_sweep_mode = 1;
+    else if (strcmp(mode, "parallel") == 0) mark_thread_count = BENCH_SUITE_THREADS;
+    else return 0;
+    return 1;
+}
+
+//  gc_bench.h operations: tracing needs no per-reference bookkeeping, so
+//  release() is a no-op and the workload's roots and links keep objects alive
+static void *benchSuiteAllocate(const char *name) {
+    return allocObject(name, "");
+}
+
+static void benchSuiteLink(void *from, void *to) {
+    addRef(from, to);
+}
+
+static void benchSuiteUnlink(void *from, void *to) {
+    removeRef(from, to);
+}
+
+static void *benchSuiteChild(void *object, int index) {
+    object_struct_t *parent = object;
+    return index < parent->ref_count ? parent->refs[index] : NULL;
+}
+
+static void benchSuitePushRoot(void *object) {
+    pushRoot(object);
+}
+
+static void benchSuiteRelease(void *object) {
+    (void)object;
+}
+
+static void benchSuiteCollect(void) {
+    gcCollect();
+    completeLazySweep();
+}
@@ -7,6 +7,28 @@ Each variable is represented by a dynamically allocated object with a
 reference count. References are incremented/decremented as simulated code
 executes, and memory is freed automatically when refcount reaches zero.
 
+Features:
+- Reference cascades on an explicit work list, so long chains cannot
+  overflow the C stack
+- Trial-deletion cycle collector (Bacon & Rajan) over buffered candidates
+- Deferred mode: heap -> heap counts only, buffered and coalesced at safe
+  points, with a zero-count table
+- Weak references through a per-object side table entry
+- Biased reference counting with C11 atomics for objects shared by threads
+- Slab pool with an intrusive free list and generation-checked handles
+- Buffered event log via gc_event_log.h (text, or binary with --binary-log)
+
+Usage:
+    refcounting_gc.exe                  Run the tiny program simulation
+    refcounting_gc.exe --binary-log ... Any mode below, logging binary records instead of text
+    refcounting_gc.exe --bench-suite [W] [S] [M] Run gc_bench.h workload W (or all) at scale S in
+                                                mode M (immediate or deferred) as CSV
+    refcounting_gc.exe --bench-shuffle [N]      Count updates and time of N pointer moves, immediate vs deferred
+    refcounting_gc.exe --bench-weak [N] [K]     N lookups in a weak-handle cache of K keys backed by a small LRU
+    refcounting_gc.exe --bench-slab [N]         N create/free pairs through the slab vs calloc/free, stale handle checks
+    refcounting_gc.exe --bench-threads [T] [P]  T threads x P retain/release pairs, naive atomics vs biased
+    refcounting_gc.exe --bench-cycles [R] [L]   Reclaim R garbage rings of L nodes beside small and large live heaps
+
 For Linux/macOS:
 Replace fopen_s, strcpy_s, etc., with fopen, strcpy, if needed.
 
@@ -24,32 +46,239 @@ Function Definitions
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <threads.h>
+#include <stdatomic.h>
+#include "gc_event_log.h"
+#include "gc_bench.h"
 
 //  Constants & Macros
-#define MAX_OBJECTS 100
+#define SLAB_SLOTS 1024                                 //  Objects per slab
+#define SLAB_DIRECTORY_INITIAL 16
+#define SLAB_NO_FREE UINT32_MAX                         //  Empty free list
+#define OBJECT_HANDLE_NULL 0                            //  Generation 0 is never live
+#define HANDLE_SLOT(handle) ((uint32_t)(handle))
+#define HANDLE_GENERATION(handle) ((uint32_t)((handle) >> 32))
+#define REFS_INITIAL_CAPACITY 4
+#define ROOTS_INITIAL_CAPACITY 64
+#define WORK_LIST_INITIAL_CAPACITY 64
+#define CYCLE_CANDIDATE_BATCH 8192                      //  Buffered candidate roots that trigger collectCycles()
+#define CYCLE_HEAP_TRIGGER_MIN 65536                    //  Objects that trigger collectCycles() on fewer candidates
+#define CYCLE_HEAP_GROWTH 2                             //  Next trigger = live objects x this
+#define RC_BUFFER_BATCH 65536                           //  Buffered increments + decrements that trigger reconcileCounts()
+#define BENCH_SHUFFLE_MOVES 10000000
+#define BENCH_SHUFFLE_HOLDERS 64
+#define BENCH_SHUFFLE_OBJECTS 4096
+#define BENCH_SLAB_PAIRS 20000000
+#define BENCH_SLAB_LIVE 4096                            //  Objects alive during the churn
+#define BENCH_WEAK_LOOKUPS 10000000
+#define BENCH_WEAK_KEYS 65536                           //  Weak handle slots in the cache
+#define BENCH_WEAK_STRONG 4096                          //  Recently used objects kept alive
+#define BENCH_THREADS_DEFAULT 4
+#define BENCH_THREADS_PAIRS 10000000                    //  Retain/release pairs per worker thread
+#define BENCH_THREADS_LOCAL_OBJECTS 256                 //  Objects each worker creates and owns
+#define BENCH_THREADS_SHARED_OBJECTS 64                 //  Main thread's objects every worker uses
+#define BENCH_THREADS_REMOTE_EVERY 16                   //  Every Nth pair touches a shared object
+#define BENCH_THREADS_OWNER_PAIRS 64                    //  Main thread's pairs between merge queue drains
+
+#define BIASED_MAX_THREADS 64
+#define BIASED_NO_OWNER UINT32_MAX                      //  owner of a merged object
+#define SHARED_MERGED 1                                 //  Biased count folded in; everyone uses the shared count
+#define SHARED_QUEUED 2                                 //  In the owner's merge queue
+#define SHARED_FLAGS 3
+#define SHARED_ONE 4                                    //  One reference in the shared word
+#define SHARED_COUNT(word) (((word) - ((word) & SHARED_FLAGS)) / SHARED_ONE)
+#define BENCH_CYCLES_RINGS 20000
+#define BENCH_CYCLES_RING_LENGTH 100
+#define BENCH_CYCLES_LIVE 100000                        //  Live chain the collector must not visit
+
+#define COLOR_BLACK 0                                   //  In use (or freed by a count reaching zero)
+#define COLOR_GRAY 1                                    //  Possible member of a garbage cycle
+#define COLOR_WHITE 2                                   //  Member of a garbage cycle
+#define COLOR_PURPLE 3                                  //  Possible root of a garbage cycle
 #define LOG_FILE "refcount.txt"
+#define LOG_BINARY_FILE "refcount.gclog"
 
 //  Struct Definitions
 typedef struct ObjectStruct {
     int refcount;
     char *name;
     char *value;
+    struct ObjectStruct **refs;                         //  Counted references to other objects
+    int ref_count;
+    int ref_capacity;
+    uint32_t slot;                                      //  Slab slot index
+    unsigned char color;                                //  COLOR_* state for the cycle collector
+    unsigned char buffered;                             //  In candidate_roots, at candidate_slot
+    unsigned char in_zct;                               //  In zero_count_table (deferred mode)
+    unsigned char touched;                              //  In coalesced, pending holds its net delta
+    unsigned char decremented;                          //  Lost a reference since the last reconcileCounts()
+    int pending;
+    size_t candidate_slot;
+    struct WeakRef *weak;                               //  Side table entry, NULL until a weak handle exists
 } object_t;
 
+//  Side table entry shared by every weak handle to one object
+typedef struct WeakRef {
+    object_t *object;                                   //  NULL once the object has been freed
+    int weak_count;                                     //  Outstanding handles; the entry dies with the last
+} weak_ref_t;
+
+//  Generation-tagged reference: slot index in the low half, generation high
+typedef uint64_t object_handle_t;
+
+//  Slab slot: a live object, or a link in the free list once it is freed
+typedef struct SlabSlot {
+    union {
+        object_t object;
+        uint32_t next_free;
+    };
+    uint32_t generation;                                //  Odd while allocated
+} slab_slot_t;
+
+//  Growable stack of object pointers (roots, release work list)
+typedef struct ObjectStack {
+    object_t **items;
+    size_t count;
+    size_t capacity;
+} object_stack_t;
+
+//  Deferred mode: count changes a thread has made since the last reconcileCounts()
+typedef struct RcBuffers {
+    object_stack_t increments;
+    object_stack_t decrements;
+} rc_buffers_t;
+
+//  Object that any thread may retain and release (biased reference counting)
+typedef struct SharedObject {
+    _Atomic uint32_t owner;                             //  Thread on the biased path, BIASED_NO_OWNER once merged
+    uint32_t home;                                      //  Creating thread, whose merge queue the object uses
+    int biased;                                         //  Owner's references, touched only by the owner
+    atomic_llong shared;                                //  Other threads' references x SHARED_ONE | SHARED_* flags
+    struct SharedObject *queue_next;                    //  Link in the home thread's merge queue
+} shared_object_t;
+
+typedef struct BiasedWorker {
+    thrd_t thread;
+    uint32_t id;
+    size_t pairs;
+    shared_object_t **shared;                           //  Main thread's objects; the worker holds one reference each
+} biased_worker_t;
+
 //  Global Variables
-static object_t *objectPool[MAX_OBJECTS];
-static int object_count = 0;
-static FILE *log_file = NULL;   // global log file pointer
+static slab_slot_t **slabs = NULL;                      //  Slab directory; the slabs themselves never move
+static size_t slab_count = 0;
+static size_t slab_directory_capacity = 0;
+static uint32_t slots_used = 0;                         //  Slots handed out at least once
+static uint32_t free_slot = SLAB_NO_FREE;               //  Head of the intrusive free list
+static size_t object_count = 0;
+static object_stack_t roots = { NULL, 0, 0 };           //  Each entry holds one count (none when deferred)
+static object_stack_t release_list = { NULL, 0, 0 };    //  Objects whose count reached zero
+static object_stack_t candidate_roots = { NULL, 0, 0 };  //  Purple objects buffered for collectCycles()
+static object_stack_t cycle_work = { NULL, 0, 0 };      //  Work list of the collectCycles() passes
+static object_stack_t black_work = { NULL, 0, 0 };      //  scanBlack() work list, nested inside scan()
+static object_stack_t cycle_garbage = { NULL, 0, 0 };   //  White objects gathered by collectWhite()
+static size_t cycles_freed = 0;                         //  Objects reclaimed by collectCycles()
+static size_t cycle_heap_trigger = CYCLE_HEAP_TRIGGER_MIN;
+
+static int deferred_mode = 0;
+static thread_local rc_buffers_t rc_buffers = { { NULL, 0, 0 }, { NULL, 0, 0 } };
+static object_stack_t coalesced = { NULL, 0, 0 };       //  Objects with a pending net delta
+static object_stack_t zero_count_table = { NULL, 0, 0 }; //  Objects at zero that a root may still hold
+static size_t count_updates = 0;                        //  Reference count writes (cycle collector excluded)
+static size_t buffered_updates = 0;                     //  Entries appended to the deferred buffers
+static size_t weak_refs_live = 0;                       //  Side table entries not yet freed
+
+static int shared_objects_biased = 1;                   //  0 = objects start merged (naive atomic counting)
+static thread_local uint32_t biased_thread_id = 0;      //  0 = main thread
+static _Atomic(shared_object_t *) merge_queues[BIASED_MAX_THREADS];
+static atomic_size_t shared_objects_live;
+static atomic_int biased_workers_running;
+static const char *log_path = LOG_FILE;
+static int log_verbose = 1;                             //  Per-object log lines (off for benchmarks)
 
 //  Function Declarations
-static void openLogFile(void);
+//  Logging
+static void openLogFile(int format);
 static void closeLogFile(void);
+
+//  Object Management
 object_t *createObject(const char *name, const char *value);
 static void retainObject(object_t *obj);
 static void releaseObject(object_t *obj);
+static void freeObject(object_t *object);
+static void addReference(object_t *from, object_t *to);
+static void removeReference(object_t *from, object_t *to);
+static void objectStackPush(object_stack_t *stack, object_t *object, size_t initial_capacity);
+static void releaseCascade(object_t *object);
 static void cleanup(void);
+
+//  Slab Pool
+static inline slab_slot_t *slabSlot(uint32_t index);
+static object_t *slabAllocate(void);
+static void slabFree(object_t *object);
+static object_handle_t objectHandle(const object_t *object);
+static object_t *resolveHandle(object_handle_t handle);
+
+//  Deferred Reference Counting
+static void addToZeroCountTable(object_t *object);
+static void safePoint(void);
+static void reconcileCounts(int collect_cycles);
+static void coalesce(object_stack_t *buffer, int delta);
+
+//  Weak References
+static weak_ref_t *createWeakRef(object_t *object);
+static object_t *lockWeakRef(weak_ref_t *weak);
+static void releaseWeakRef(weak_ref_t *weak);
+
+//  Biased Reference Counting
+static void biasedAttachThread(uint32_t id);
+static shared_object_t *createSharedObject(void);
+static void retainShared(shared_object_t *object);
+static void releaseShared(shared_object_t *object);
+static void mergeBiased(shared_object_t *object);
+static void enqueueMerge(shared_object_t *object);
+static void processMergeQueue(void);
+static void freeSharedObject(shared_object_t *object);
+
+//  Cycle Collection
+static void possibleRoot(object_t *object);
+static void removeCandidate(object_t *object);
+static int cycleCollectionDue(void);
+static void collectCycles(void);
+static void markGray(object_t *object);
+static void scan(object_t *object);
+static void scanBlack(object_t *object);
+static void collectWhite(object_t *object);
+
+//  Root Management
+static void pushRoot(object_t *object);
+static void popRoot(void);
+
+//  Utility Functions
 static inline void free_s(void **ptr);
+static double elapsedSeconds(const struct timespec *start);
+
+//  Simulation Functions
 static void simulateProgram(void);
+static void simulateCycle(void);
+static void simulateWeakRef(void);
+
+//  Benchmarks
+static void *benchSuiteAllocate(const char *name);
+static void benchSuiteLink(void *from, void *to);
+static void benchSuiteUnlink(void *from, void *to);
+static void *benchSuiteChild(void *object, int index);
+static void benchSuitePushRoot(void *object);
+static void benchSuiteRelease(void *object);
+static void benchSuiteCollect(void);
+static void benchCycles(size_t ring_count, size_t ring_length, size_t live_count);
+static void benchShuffle(const char *label, int deferred, size_t moves);
+static void benchSlab(size_t pairs);
+static void benchWeakCache(size_t lookups, size_t key_count);
+static int biasedWorkerMain(void *arg);
+static double benchThreads(const char *label, int biased, int thread_count, size_t pairs);
 
 //  Utility Function: (Safe free)
 static inline void free_s(void **ptr) {
@@ -59,106 +288,771 @@ static inline void free_s(void **ptr) {
     }
 }
 
+static double elapsedSeconds(const struct timespec *start) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
 //  Logging Functions
-static void openLogFile(void) {
-    errno_t error = fopen_s(&log_file, LOG_FILE, "w");
-    if (error != 0 || log_file == NULL) {
-        fprintf(stderr, "ERROR: Could not open %s for writing.\n", LOG_FILE);
+static void openLogFile(int format) {
+    log_path = format == GC_LOG_FORMAT_BINARY ? LOG_BINARY_FILE : LOG_FILE;
+    if (!gcLogOpen(log_path, format)) {
+        fprintf(stderr, "ERROR: Could not open %s for writing.\n", log_path);
         exit(EXIT_FAILURE);
     }
 }
 
 static void closeLogFile(void) {
-    if (log_file) {
-        fclose(log_file);
-        log_file = NULL;
-    }
+    gcLogClose();
 }
 
 //  Object Management Functions
 object_t *createObject(const char *name, const char *value) {
-    if (object_count >= MAX_OBJECTS) {
-        fprintf(stderr, "ERROR: Object pool full.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    object_t *object = calloc(1, sizeof(object_t));
-    if (!object) {
-        fprintf(stderr, "ERROR: Memory allocation failed.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    object->refcount = 1;
+    safePoint();
+    object_t *object = slabAllocate();
+    object->refcount = deferred_mode ? 0 : 1;          //  The creator's stack reference is uncounted when deferred
     object->name = _strdup(name);
     object->value = _strdup(value);
-    objectPool[object_count++] = object;
+    object_count++;
+    if (deferred_mode) addToZeroCountTable(object);
 
-    fprintf(log_file, "Created %s = %s (refs = %d)\n", object->name, object->value, object->refcount);
-    fflush(log_file);
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_RC_CREATE, object->name, object->value, object->refcount);
     return object;
 }
 
 static void retainObject(object_t *object) {
-    if (object) {
+    if (object && !deferred_mode) {
+        count_updates++;
         object->refcount++;
-        fprintf(log_file, "Retained %s (refs = %d)\n", object->name, object->refcount);
-        fflush(log_file);
+        object->color = COLOR_BLACK;
+        if (log_verbose) GC_LOG_OBJECT(GC_EVENT_RC_RETAIN, object->name, NULL, object->refcount);
     }
 }
 
+//  A count reaching zero frees the object and releases its references; the
+//  cascade runs off release_list so its depth never touches the C stack. A
+//  count left above zero makes the object a candidate cycle root.
 static void releaseObject(object_t *object) {
-    if (!object) return;
+    if (!object || deferred_mode) return;
 
+    count_updates++;
     object->refcount--;
-    fprintf(log_file, "Released %s (refs = %d)\n", object->name, object->refcount);
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_RC_RELEASE, object->name, NULL, object->refcount);
+    if (object->refcount > 0) {
+        possibleRoot(object);
+    } else {
+        struct timespec start;
+        timespec_get(&start, TIME_UTC);
+        releaseCascade(object);
+        gcBenchRecordPause(elapsedSeconds(&start));
+    }
+
+    if (cycleCollectionDue()) collectCycles();
+}
 
-    if (object->refcount <= 0)  {
-        fprintf(log_file, "Freeing %s\n", object->name);
+//  Frees an object whose count is zero and everything only it kept alive
+static void releaseCascade(object_t *object) {
+    objectStackPush(&release_list, object, WORK_LIST_INITIAL_CAPACITY);
+    while (release_list.count > 0) {
+        object_t *dead = release_list.items[--release_list.count];
+        for (int i = 0; i < dead->ref_count; i++) {
+            object_t *child = dead->refs[i];
+            count_updates++;
+            child->refcount--;
+            if (log_verbose) GC_LOG_OBJECT(GC_EVENT_RC_RELEASE, child->name, NULL, child->refcount);
+            if (child->refcount == 0) objectStackPush(&release_list, child, WORK_LIST_INITIAL_CAPACITY);
+            else possibleRoot(child);
+        }
+        dead->ref_count = 0;
+        dead->color = COLOR_BLACK;
+        if (dead->buffered) removeCandidate(dead);
+        freeObject(dead);
+    }
+}
+
+//  Frees the object without touching its references and returns its slot
+static void freeObject(object_t *object) {
+    if (log_verbose) GC_LOG_OBJECT(GC_EVENT_RC_FREE, object->name, NULL, 0);
+    if (object->weak) object->weak->object = NULL;      //  Weak handles now read NULL
+    free_s((void **)&object->refs);
+    free_s((void **)&object->name);
+    free_s((void **)&object->value);
+    slabFree(object);
+    object_count--;
+}
+
+static void addReference(object_t *from, object_t *to) {
+    if (!from || !to) return;
+    if (from->ref_count == from->ref_capacity) {
+        int new_capacity = from->ref_capacity ? from->ref_capacity * 2 : REFS_INITIAL_CAPACITY;
+        object_t **refs = realloc(from->refs, (size_t)new_capacity * sizeof(*refs));
+        if (!refs) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        from->refs = refs;
+        from->ref_capacity = new_capacity;
+    }
+
+    from->refs[from->ref_count++] = to;
+    if (deferred_mode) {
+        objectStackPush(&rc_buffers.increments, to, RC_BUFFER_BATCH);
+        buffered_updates++;
+    } else {
+        retainObject(to);
+    }
+}
+
+//  Drops the first from -> to reference, keeping the others in order
+static void removeReference(object_t *from, object_t *to) {
+    if (!from || !to) return;
+    int i;
+    for (i = 0; i < from->ref_count; i++) {
+        if (from->refs[i] == to) break;
+    }
+
+    if (i == from->ref_count) return;
+    for (; i + 1 < from->ref_count; i++) {
+        from->refs[i] = from->refs[i + 1];
+    }
+
+    from->ref_count--;
+    if (deferred_mode) {
+        objectStackPush(&rc_buffers.decrements, to, RC_BUFFER_BATCH);
+        buffered_updates++;
+    } else {
+        releaseObject(to);
+    }
+}
+
+static void objectStackPush(object_stack_t *stack, object_t *object, size_t initial_capacity) {
+    if (stack->count == stack->capacity) {
+        size_t new_capacity = stack->capacity ? stack->capacity * 2 : initial_capacity;
+        object_t **items = realloc(stack->items, new_capacity * sizeof(*items));
+        if (!items) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        stack->items = items;
+        stack->capacity = new_capacity;
+    }
+    stack->items[stack->count++] = object;
+}
+
+//  Force-frees whatever is still alive (leaked cycles, the simulation's last
+//  object) and releases the slabs themselves
+static void cleanup(void) {
+    for (uint32_t i = 0; i < slots_used; i++) {
+        slab_slot_t *slot = slabSlot(i);
+        if (!(slot->generation & 1)) continue;
+        object_t *object = &slot->object;
+        if (log_verbose) GC_LOG_OBJECT(GC_EVENT_RC_FORCE_FREE, object->name, NULL, 0);
+        if (object->weak) object->weak->object = NULL;
+        free_s((void **)&object->refs);
         free_s((void **)&object->name);
         free_s((void **)&object->value);
-        free_s((void **)&object);
     }
+    for (size_t i = 0; i < slab_count; i++) free(slabs[i]);
+    free_s((void **)&slabs);
+    slab_count = slab_directory_capacity = 0;
+    slots_used = 0;
+    free_slot = SLAB_NO_FREE;
+    object_count = 0;
+    free_s((void **)&roots.items);
+    roots.count = roots.capacity = 0;
+    free_s((void **)&release_list.items);
+    release_list.capacity = 0;
+    free_s((void **)&candidate_roots.items);
+    candidate_roots.count = candidate_roots.capacity = 0;
+    free_s((void **)&cycle_work.items);
+    cycle_work.capacity = 0;
+    free_s((void **)&black_work.items);
+    black_work.capacity = 0;
+    free_s((void **)&cycle_garbage.items);
+    cycle_garbage.capacity = 0;
+    object_stack_t *deferred[] = { &rc_buffers.increments, &rc_buffers.decrements, &coalesced, &zero_count_table };
+    for (size_t i = 0; i < sizeof(deferred) / sizeof(deferred[0]); i++) {
+        free_s((void **)&deferred[i]->items);
+        deferred[i]->count = deferred[i]->capacity = 0;
+    }
+}
 
-    fflush(log_file);
+//  Slab Pool Functions
+static inline slab_slot_t *slabSlot(uint32_t index) {
+    return &slabs[index / SLAB_SLOTS][index % SLAB_SLOTS];
 }
 
-static void cleanup(void) {
-    for (int i = 0; i < object_count; i++) {
-        if (objectPool[i]) {
-            fprintf(log_file, "Force cleanup: %s\n", objectPool[i]->name);
-            free_s((void **)&objectPool[i]->name);
-            free_s((void **)&objectPool[i]->value);
-            free_s((void **)&objectPool[i]);
-            objectPool[i] = NULL;
+//  Pop the free list, or take the next never-used slot (adding a slab when
+//  the last one is full); returns a zeroed object
+static object_t *slabAllocate(void) {
+    uint32_t index;
+    if (free_slot != SLAB_NO_FREE) {
+        index = free_slot;
+        free_slot = slabSlot(index)->next_free;
+    } else {
+        if (slots_used == slab_count * SLAB_SLOTS) {
+            if (slots_used > SLAB_NO_FREE - SLAB_SLOTS) {
+                fprintf(stderr, "ERROR: Slab pool exhausted.\n");
+                exit(EXIT_FAILURE);
+            }
+            if (slab_count == slab_directory_capacity) {
+                size_t new_capacity = slab_directory_capacity ? slab_directory_capacity * 2 : SLAB_DIRECTORY_INITIAL;
+                slab_slot_t **directory = realloc(slabs, new_capacity * sizeof(*directory));
+                if (!directory) {
+                    fprintf(stderr, "ERROR: Memory allocation failed.\n");
+                    exit(EXIT_FAILURE);
+                }
+                slabs = directory;
+                slab_directory_capacity = new_capacity;
+            }
+            slabs[slab_count] = calloc(SLAB_SLOTS, sizeof(slab_slot_t));
+            if (!slabs[slab_count]) {
+                fprintf(stderr, "ERROR: Memory allocation failed.\n");
+                exit(EXIT_FAILURE);
+            }
+            slab_count++;
         }
+        index = slots_used++;
+    }
+
+    slab_slot_t *slot = slabSlot(index);
+    slot->generation++;                                 //  Odd: allocated
+    memset(&slot->object, 0, sizeof(slot->object));
+    slot->object.slot = index;
+    return &slot->object;
+}
+
+//  The object is the first member of its slot, so the cast finds the slot
+static void slabFree(object_t *object) {
+    uint32_t index = object->slot;
+    slab_slot_t *slot = (slab_slot_t *)object;
+    slot->generation++;                                 //  Even: free; older handles go stale
+    slot->next_free = free_slot;
+    free_slot = index;
+}
+
+static object_handle_t objectHandle(const object_t *object) {
+    if (!object) return OBJECT_HANDLE_NULL;
+    const slab_slot_t *slot = (const slab_slot_t *)object;
+    return (object_handle_t)slot->generation << 32 | object->slot;
+}
+
+//  NULL for the null handle and for any handle whose object has been freed
+static object_t *resolveHandle(object_handle_t handle) {
+    uint32_t index = HANDLE_SLOT(handle);
+    if (index >= slots_used) return NULL;
+    slab_slot_t *slot = slabSlot(index);
+    return slot->generation == HANDLE_GENERATION(handle) && (slot->generation & 1) ? &slot->object : NULL;
+}
+
+//  Deferred Reference Counting Functions
+//  Only heap -> heap references are counted: retainObject(), releaseObject()
+//  and the root stack touch no count, a new object starts at zero in the
+//  zero-count table, and addReference()/removeReference() only buffer their
+//  change until reconcileCounts()
+static void addToZeroCountTable(object_t *object) {
+    if (object->in_zct) return;
+    object->in_zct = 1;
+    objectStackPush(&zero_count_table, object, WORK_LIST_INITIAL_CAPACITY);
+}
+
+//  Called where the mutator holds no object that is not reachable from a root
+static void safePoint(void) {
+    if (deferred_mode && rc_buffers.increments.count + rc_buffers.decrements.count >= RC_BUFFER_BATCH) {
+        reconcileCounts(0);
+    }
+}
+
+//  Sum each buffered object's changes into its pending delta
+static void coalesce(object_stack_t *buffer, int delta) {
+    for (size_t i = 0; i < buffer->count; i++) {
+        object_t *object = buffer->items[i];
+        if (!object->touched) {
+            object->touched = 1;
+            objectStackPush(&coalesced, object, WORK_LIST_INITIAL_CAPACITY);
+        }
+        object->pending += delta;
+        if (delta < 0) object->decremented = 1;
+    }
+    buffer->count = 0;
+}
+
+//  Apply the calling thread's buffered changes. The roots are counted while
+//  this runs, so neither the ZCT pass nor collectCycles() can free a rooted
+//  object.
+static void reconcileCounts(int collect_cycles) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    for (size_t i = 0; i < roots.count; i++) {
+        count_updates++;
+        roots.items[i]->refcount++;
+    }
+
+    coalesce(&rc_buffers.increments, 1);
+    coalesce(&rc_buffers.decrements, -1);
+    for (size_t i = 0; i < coalesced.count; i++) {
+        object_t *object = coalesced.items[i];
+        int delta = object->pending;
+        int decremented = object->decremented;
+        object->pending = 0;
+        object->touched = 0;
+        object->decremented = 0;
+        if (delta != 0) {
+            count_updates++;
+            object->refcount += delta;
+        }
+
+        //  Any lost reference can have cut a cycle loose, even when the net
+        //  delta is not negative
+        if (object->refcount == 0) addToZeroCountTable(object);
+        else if (decremented) possibleRoot(object);
+        else object->color = COLOR_BLACK;
+    }
+    coalesced.count = 0;
+
+    //  Drop the entries that gained a count first: a cascade may free them
+    size_t kept = 0;
+    for (size_t i = 0; i < zero_count_table.count; i++) {
+        object_t *object = zero_count_table.items[i];
+        if (object->refcount == 0) zero_count_table.items[kept++] = object;
+        else object->in_zct = 0;
+    }
+    zero_count_table.count = kept;
+    for (size_t i = 0; i < zero_count_table.count; i++) {
+        zero_count_table.items[i]->in_zct = 0;
+        releaseCascade(zero_count_table.items[i]);
+    }
+    zero_count_table.count = 0;
+
+    if (collect_cycles || cycleCollectionDue()) collectCycles();
+
+    for (size_t i = 0; i < roots.count; i++) {
+        count_updates++;
+        if (--roots.items[i]->refcount == 0) addToZeroCountTable(roots.items[i]);
+    }
+    gcBenchRecordPause(elapsedSeconds(&start));
+}
+
+//  Weak Reference Functions
+//  Every call returns a handle the caller gives back with releaseWeakRef()
+static weak_ref_t *createWeakRef(object_t *object) {
+    if (!object) return NULL;
+    if (!object->weak) {
+        object->weak = calloc(1, sizeof(weak_ref_t));
+        if (!object->weak) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        object->weak->object = object;
+        weak_refs_live++;
+    }
+    object->weak->weak_count++;
+    return object->weak;
+}
+
+//  A strong reference to the object, or NULL once it has been freed
+static object_t *lockWeakRef(weak_ref_t *weak) {
+    if (!weak || !weak->object) return NULL;
+    retainObject(weak->object);
+    return weak->object;
+}
+
+static void releaseWeakRef(weak_ref_t *weak) {
+    if (!weak || --weak->weak_count > 0) return;
+    if (weak->object) weak->object->weak = NULL;
+    free(weak);
+    weak_refs_live--;
+}
+
+//  Biased Reference Counting Functions
+//  The owner counts its references in biased, other threads in the atomic
+//  shared word. When biased drops to zero it is merged into shared and every
+//  thread takes the atomic path. A non-owner release that drives an unmerged
+//  shared count negative queues the object for its owner, and only that
+//  drain frees it. Threads call biasedAttachThread() before touching one.
+static void biasedAttachThread(uint32_t id) {
+    biased_thread_id = id;
+}
+
+//  The creator holds the first reference, on the biased path unless naive
+static shared_object_t *createSharedObject(void) {
+    shared_object_t *object = calloc(1, sizeof(shared_object_t));
+    if (!object) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    object->home = biased_thread_id;
+    if (shared_objects_biased) {
+        atomic_init(&object->owner, biased_thread_id);
+        object->biased = 1;
+        atomic_init(&object->shared, 0);
+    } else {
+        atomic_init(&object->owner, BIASED_NO_OWNER);
+        atomic_init(&object->shared, SHARED_ONE | SHARED_MERGED);
+    }
+    atomic_fetch_add_explicit(&shared_objects_live, 1, memory_order_relaxed);
+    return object;
+}
+
+//  owner only ever changes on the owner's own thread, so a relaxed load is
+//  enough to pick the path
+static void retainShared(shared_object_t *object) {
+    if (atomic_load_explicit(&object->owner, memory_order_relaxed) == biased_thread_id) {
+        object->biased++;
+        return;
+    }
+    atomic_fetch_add_explicit(&object->shared, SHARED_ONE, memory_order_relaxed);
+}
+
+static void releaseShared(shared_object_t *object) {
+    if (atomic_load_explicit(&object->owner, memory_order_relaxed) == biased_thread_id) {
+        if (--object->biased == 0) mergeBiased(object);
+        return;
+    }
+
+    long long old_word = atomic_load_explicit(&object->shared, memory_order_relaxed);
+    if (old_word & SHARED_MERGED) {                     //  Merged objects never become queued again
+        long long new_word = atomic_fetch_sub_explicit(&object->shared, SHARED_ONE, memory_order_acq_rel) - SHARED_ONE;
+        if (!(new_word & SHARED_QUEUED) && SHARED_COUNT(new_word) == 0) freeSharedObject(object);
+        return;
+    }
+
+    //  A negative shared count means the owner's biased count still holds
+    //  references that were handed to other threads; the owner must merge
+    long long new_word;
+    do {
+        new_word = old_word - SHARED_ONE;
+        if (!(old_word & SHARED_MERGED) && SHARED_COUNT(new_word) < 0) new_word |= SHARED_QUEUED;
+    } while (!atomic_compare_exchange_weak_explicit(&object->shared, &old_word, new_word, memory_order_acq_rel,
+                                                    memory_order_relaxed));
+
+    if ((new_word & SHARED_QUEUED) && !(old_word & SHARED_QUEUED)) enqueueMerge(object);
+    else if ((new_word & SHARED_MERGED) && !(new_word & SHARED_QUEUED) && SHARED_COUNT(new_word) == 0) {
+        freeSharedObject(object);
+    }
+}
+
+//  Owner only: fold the biased count into the shared word and give up the
+//  biased path. A queued object is left for processMergeQueue() to free.
+static void mergeBiased(shared_object_t *object) {
+    long long add = (long long)object->biased * SHARED_ONE;
+    object->biased = 0;
+    long long old_word = atomic_load_explicit(&object->shared, memory_order_relaxed);
+    long long new_word;
+    do {
+        new_word = (old_word + add) | SHARED_MERGED;
+    } while (!atomic_compare_exchange_weak_explicit(&object->shared, &old_word, new_word, memory_order_acq_rel,
+                                                    memory_order_relaxed));
+    atomic_store_explicit(&object->owner, BIASED_NO_OWNER, memory_order_relaxed);
+
+    if (!(new_word & SHARED_QUEUED) && SHARED_COUNT(new_word) == 0) freeSharedObject(object);
+}
+
+//  Treiber stack push; only the home thread ever pops, and it takes the
+//  whole list at once, so there is no ABA problem
+static void enqueueMerge(shared_object_t *object) {
+    _Atomic(shared_object_t *) *queue = &merge_queues[object->home];
+    shared_object_t *head = atomic_load_explicit(queue, memory_order_relaxed);
+    do {
+        object->queue_next = head;
+    } while (!atomic_compare_exchange_weak_explicit(queue, &head, object, memory_order_release, memory_order_relaxed));
+}
+
+//  Run by each thread at its own safe points: merge every object another
+//  thread queued, then clear SHARED_QUEUED and free what reached zero
+static void processMergeQueue(void) {
+    shared_object_t *object = atomic_exchange_explicit(&merge_queues[biased_thread_id], NULL, memory_order_acquire);
+    while (object) {
+        shared_object_t *next = object->queue_next;
+        if (atomic_load_explicit(&object->owner, memory_order_relaxed) != BIASED_NO_OWNER) mergeBiased(object);
+
+        long long new_word = atomic_fetch_and_explicit(&object->shared, ~(long long)SHARED_QUEUED,
+                                                       memory_order_acq_rel) & ~(long long)SHARED_QUEUED;
+        if (SHARED_COUNT(new_word) == 0) freeSharedObject(object);
+        object = next;
+    }
+}
+
+static void freeSharedObject(shared_object_t *object) {
+    free(object);
+    atomic_fetch_sub_explicit(&shared_objects_live, 1, memory_order_relaxed);
+}
+
+//  Cycle Collection Functions
+static void possibleRoot(object_t *object) {
+    if (object->color == COLOR_PURPLE) return;
+    object->color = COLOR_PURPLE;
+    if (!object->buffered) {
+        object->buffered = 1;
+        object->candidate_slot = candidate_roots.count;
+        objectStackPush(&candidate_roots, object, CYCLE_CANDIDATE_BATCH);
+    }
+}
+
+//  A candidate whose count reached zero is freed at once, not at the next
+//  collection, so it leaves the buffer in O(1)
+static void removeCandidate(object_t *object) {
+    object_t *last = candidate_roots.items[--candidate_roots.count];
+    candidate_roots.items[object->candidate_slot] = last;
+    last->candidate_slot = object->candidate_slot;
+    object->buffered = 0;
+}
+
+//  A full buffer, or a few candidates that may be holding a growing heap:
+//  one purple head can keep an arbitrarily large garbage cycle alive
+static int cycleCollectionDue(void) {
+    if (candidate_roots.count >= CYCLE_CANDIDATE_BATCH) return 1;
+    return candidate_roots.count > 0 && object_count >= cycle_heap_trigger;
+}
+
+//  Trial deletion over the subgraphs reachable from the buffered candidates
+static void collectCycles(void) {
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    size_t candidates = candidate_roots.count;
+    size_t freed_before = cycles_freed;
+
+    //  Keep only candidates that are still purple (retained ones turned black)
+    size_t kept = 0;
+    for (size_t i = 0; i < candidate_roots.count; i++) {
+        object_t *object = candidate_roots.items[i];
+        if (object->color == COLOR_PURPLE) {
+            markGray(object);
+            object->candidate_slot = kept;
+            candidate_roots.items[kept++] = object;
+            continue;
+        }
+        object->buffered = 0;
+    }
+    candidate_roots.count = kept;
+
+    for (size_t i = 0; i < candidate_roots.count; i++) scan(candidate_roots.items[i]);
+
+    //  Gather every white object before freeing any, so no pass reads a freed
+    //  child. Counts into surviving objects were already dropped by markGray().
+    for (size_t i = 0; i < candidate_roots.count; i++) candidate_roots.items[i]->buffered = 0;
+    for (size_t i = 0; i < candidate_roots.count; i++) collectWhite(candidate_roots.items[i]);
+    candidate_roots.count = 0;
+    for (size_t i = 0; i < cycle_garbage.count; i++) freeObject(cycle_garbage.items[i]);
+    cycles_freed += cycle_garbage.count;
+    cycle_garbage.count = 0;
+    cycle_heap_trigger = object_count * CYCLE_HEAP_GROWTH;
+    if (cycle_heap_trigger < CYCLE_HEAP_TRIGGER_MIN) cycle_heap_trigger = CYCLE_HEAP_TRIGGER_MIN;
+
+    gcBenchRecordPause(elapsedSeconds(&start));
+    if (log_verbose) {
+        GC_LOG_TEXT("Cycle collection: %zu candidates, %zu objects freed\n", candidates, cycles_freed - freed_before);
     }
-    object_count = 0;
-    fflush(log_file);
+}
+
+//  Subtract the references internal to the subgraph below object
+static void markGray(object_t *object) {
+    if (object->color == COLOR_GRAY) return;
+    object->color = COLOR_GRAY;
+    objectStackPush(&cycle_work, object, WORK_LIST_INITIAL_CAPACITY);
+    while (cycle_work.count > 0) {
+        object_t *gray = cycle_work.items[--cycle_work.count];
+        for (int i = 0; i < gray->ref_count; i++) {
+            object_t *child = gray->refs[i];
+            child->refcount--;
+            if (child->color != COLOR_GRAY) {
+                child->color = COLOR_GRAY;
+                objectStackPush(&cycle_work, child, WORK_LIST_INITIAL_CAPACITY);
+            }
+        }
+    }
+}
+
+//  Gray objects still referenced from outside are live again; the rest turn
+//  white. Order does not matter: scanBlack() also revives white objects.
+static void scan(object_t *object) {
+    objectStackPush(&cycle_work, object, WORK_LIST_INITIAL_CAPACITY);
+    while (cycle_work.count > 0) {
+        object_t *gray = cycle_work.items[--cycle_work.count];
+        if (gray->color != COLOR_GRAY) continue;
+        if (gray->refcount > 0) {
+            scanBlack(gray);
+            continue;
+        }
+        gray->color = COLOR_WHITE;
+        for (int i = 0; i < gray->ref_count; i++) {
+            objectStackPush(&cycle_work, gray->refs[i], WORK_LIST_INITIAL_CAPACITY);
+        }
+    }
+}
+
+//  Restore the counts markGray() subtracted below a live object; uses its
+//  own work list because scan() may still have entries queued
+static void scanBlack(object_t *object) {
+    object->color = COLOR_BLACK;
+    objectStackPush(&black_work, object, WORK_LIST_INITIAL_CAPACITY);
+    while (black_work.count > 0) {
+        object_t *black = black_work.items[--black_work.count];
+        for (int i = 0; i < black->ref_count; i++) {
+            object_t *child = black->refs[i];
+            child->refcount++;
+            if (child->color != COLOR_BLACK) {
+                child->color = COLOR_BLACK;
+                objectStackPush(&black_work, child, WORK_LIST_INITIAL_CAPACITY);
+            }
+        }
+    }
+}
+
+//  Move the white objects below object onto cycle_garbage
+static void collectWhite(object_t *object) {
+    if (object->color != COLOR_WHITE) return;
+    object->color = COLOR_BLACK;
+    objectStackPush(&cycle_work, object, WORK_LIST_INITIAL_CAPACITY);
+    while (cycle_work.count > 0) {
+        object_t *white = cycle_work.items[--cycle_work.count];
+        objectStackPush(&cycle_garbage, white, WORK_LIST_INITIAL_CAPACITY);
+        for (int i = 0; i < white->ref_count; i++) {
+            object_t *child = white->refs[i];
+            if (child->color == COLOR_WHITE) {
+                child->color = COLOR_BLACK;
+                objectStackPush(&cycle_work, child, WORK_LIST_INITIAL_CAPACITY);
+            }
+        }
+    }
+}
+
+//  Root Management Functions
+//  In deferred mode root references are uncounted: retainObject() and
+//  releaseObject() leave the count alone and popped roots wait in the ZCT
+static void pushRoot(object_t *object) {
+    objectStackPush(&roots, object, ROOTS_INITIAL_CAPACITY);
+    retainObject(object);
+}
+
+static void popRoot(void) {
+    if (roots.count == 0) return;
+    object_t *object = roots.items[--roots.count];
+    if (deferred_mode && object->refcount == 0) addToZeroCountTable(object);
+    releaseObject(object);
 }
 
 //  Driver Code
-int main(void) {
+int main(int argc, char **argv) {
     printf("= Reference Counting Simulator =\n");
 
-    openLogFile();
+    int log_format = GC_LOG_FORMAT_TEXT;
+    if (argc >= 2 && strcmp(argv[1], "--binary-log") == 0) {
+        log_format = GC_LOG_FORMAT_BINARY;
+        argc--;
+        argv++;
+    }
+    openLogFile(log_format);
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-suite") == 0) {
+        const char *workload = argc >= 3 ? argv[2] : "all";
+        size_t scale = argc >= 4 ? strtoull(argv[3], NULL, 10) : 1;
+        const char *mode = argc >= 5 ? argv[4] : "immediate";
+        if (strcmp(mode, "deferred") == 0) {
+            deferred_mode = 1;
+        } else if (strcmp(mode, "immediate") != 0) {
+            fprintf(stderr, "ERROR: Unknown counting mode %s\n", mode);
+            closeLogFile();
+            return EXIT_FAILURE;
+        }
+
+        static const gc_bench_ops_t ops = { "refcount", benchSuiteAllocate, benchSuiteLink, benchSuiteUnlink,
+                                            benchSuiteChild, benchSuitePushRoot, popRoot, benchSuiteRelease,
+                                            benchSuiteCollect };
+        log_verbose = 0;
+        int status = gcBenchMain(&ops, workload, scale);
+        cleanup();
+        closeLogFile();
+        return status;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-shuffle") == 0) {
+        size_t moves = BENCH_SHUFFLE_MOVES;
+        if (argc >= 3) moves = strtoull(argv[2], NULL, 10);
+
+        log_verbose = 0;
+        benchShuffle("immediate", 0, moves);
+        benchShuffle("deferred", 1, moves);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-slab") == 0) {
+        size_t pairs = BENCH_SLAB_PAIRS;
+        if (argc >= 3) pairs = strtoull(argv[2], NULL, 10);
+
+        log_verbose = 0;
+        benchSlab(pairs);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-weak") == 0) {
+        size_t lookups = BENCH_WEAK_LOOKUPS;
+        size_t key_count = BENCH_WEAK_KEYS;
+        if (argc >= 3) lookups = strtoull(argv[2], NULL, 10);
+        if (argc >= 4) key_count = strtoull(argv[3], NULL, 10);
+        if (key_count == 0) key_count = 1;
+
+        log_verbose = 0;
+        benchWeakCache(lookups, key_count);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-threads") == 0) {
+        int thread_count = BENCH_THREADS_DEFAULT;
+        size_t pairs = BENCH_THREADS_PAIRS;
+        if (argc >= 3) thread_count = atoi(argv[2]);
+        if (argc >= 4) pairs = strtoull(argv[3], NULL, 10);
+        if (thread_count < 1) thread_count = 1;
+        if (thread_count >= BIASED_MAX_THREADS) thread_count = BIASED_MAX_THREADS - 1;
+
+        log_verbose = 0;
+        double naive_rate = benchThreads("naive", 0, thread_count, pairs);
+        double biased_rate = benchThreads("biased", 1, thread_count, pairs);
+        printf("biased speedup: %.2fx\n", naive_rate > 0.0 ? biased_rate / naive_rate : 0.0);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "--bench-cycles") == 0) {
+        size_t ring_count = BENCH_CYCLES_RINGS;
+        size_t ring_length = BENCH_CYCLES_RING_LENGTH;
+        if (argc >= 3) ring_count = strtoull(argv[2], NULL, 10);
+        if (argc >= 4) ring_length = strtoull(argv[3], NULL, 10);
+        if (ring_length < 2) ring_length = 2;
+
+        log_verbose = 0;
+        benchCycles(ring_count, ring_length, 0);
+        benchCycles(ring_count, ring_length, BENCH_CYCLES_LIVE);
+        benchCycles(ring_count, ring_length, BENCH_CYCLES_LIVE * 10);
+        closeLogFile();
+        return EXIT_SUCCESS;
+    }
+
     simulateProgram();
+    simulateCycle();
+    simulateWeakRef();
     cleanup();
     closeLogFile();
 
-    printf("Simulation complete. Log written to %s\n", LOG_FILE);
+    printf("Simulation complete. Log written to %s\n", log_path);
     return EXIT_SUCCESS;
 }
 
 //  Simulation of a Tiny "C Program"
 static void simulateProgram(void) {
-    fprintf(log_file, "= Simulating Tiny C Program =\n\n");
-    fprintf(log_file, "int main() {\n");
-    fprintf(log_file, "    int a = 5;\n");
-    fprintf(log_file, "    if (a < 10) {\n");
-    fprintf(log_file, "        a = a + 1;\n");
-    fprintf(log_file, "    }\n");
-    fprintf(log_file, "    return 0;\n");
-    fprintf(log_file, "}\n\n");
+    GC_LOG_TEXT("= Simulating Tiny C Program =\n\n");
+    GC_LOG_TEXT("int main() {\n");
+    GC_LOG_TEXT("    int a = 5;\n");
+    GC_LOG_TEXT("    if (a < 10) {\n");
+    GC_LOG_TEXT("        a = a + 1;\n");
+    GC_LOG_TEXT("    }\n");
+    GC_LOG_TEXT("    return 0;\n");
+    GC_LOG_TEXT("}\n\n");
 
     // Simulate: int a = 5;
     object_t *a = createObject("a", "5");
@@ -175,6 +1069,379 @@ static void simulateProgram(void) {
 
     //  End of block
     releaseObject(a);
-    fprintf(log_file, "\n= Program End =\n");
-    fflush(log_file);
+    GC_LOG_TEXT("\n= Program End =\n");
+}
+
+//  x <-> y survive their last outside release; only collectCycles() frees them
+static void simulateCycle(void) {
+    GC_LOG_TEXT("\n= Simulating cycle example =\n");
+    object_t *x = createObject("x", "obj_x");
+    object_t *y = createObject("y", "obj_y");
+
+    GC_LOG_TEXT("Creating cycle: x <-> y\n");
+    addReference(x, y);
+    addReference(y, x);
+
+    GC_LOG_TEXT("Dropping local references to x and y\n");
+    releaseObject(x);
+    releaseObject(y);
+
+    collectCycles();
+}
+
+//  A weak handle observes config without keeping it alive
+static void simulateWeakRef(void) {
+    GC_LOG_TEXT("\n= Simulating weak reference example =\n");
+    object_t *config = createObject("config", "cfg");
+    weak_ref_t *handle = createWeakRef(config);
+    GC_LOG_TEXT("Weak handle to config created\n");
+
+    object_t *locked = lockWeakRef(handle);
+    GC_LOG_TEXT("Weak lookup: %s\n", locked ? locked->name : "(null)");
+    releaseObject(locked);
+
+    GC_LOG_TEXT("Dropping the last strong reference to config\n");
+    releaseObject(config);
+    locked = lockWeakRef(handle);
+    GC_LOG_TEXT("Weak lookup: %s\n", locked ? locked->name : "(null)");
+    releaseWeakRef(handle);
+}
+
+//  gc_bench.h operations: the reference allocate() returns is the one
+//  createObject() counts, and release() gives it back
+static void *benchSuiteAllocate(const char *name) {
+    return createObject(name, "");
+}
+
+static void benchSuiteLink(void *from, void *to) {
+    addReference(from, to);
+}
+
+static void benchSuiteUnlink(void *from, void *to) {
+    removeReference(from, to);
+}
+
+static void *benchSuiteChild(void *object, int index) {
+    object_t *parent = object;
+    return index < parent->ref_count ? parent->refs[index] : NULL;
+}
+
+static void benchSuitePushRoot(void *object) {
+    pushRoot(object);
+}
+
+static void benchSuiteRelease(void *object) {
+    releaseObject(object);
+}
+
+//  Acyclic garbage is already gone unless counts are deferred; flush the
+//  buffered changes and cycle candidates
+static void benchSuiteCollect(void) {
+    if (deferred_mode) reconcileCounts(1);
+    else collectCycles();
+}
+
+//  Garbage rings reclaimed next to a rooted chain of live_count objects. The
+//  chain is settled before timing starts, so the time should not grow with it.
+static void benchCycles(size_t ring_count, size_t ring_length, size_t live_count) {
+    object_t *live = createObject("live", "");
+    pushRoot(live);
+    releaseObject(live);
+    for (object_t *tail = live; live_count > 1; live_count--) {
+        object_t *next = createObject("live", "");
+        addReference(tail, next);
+        releaseObject(next);
+        tail = next;
+    }
+    collectCycles();
+    size_t live_objects = object_count;
+    size_t freed_before = cycles_freed;
+
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    for (size_t r = 0; r < ring_count; r++) {
+        object_t *head = createObject("ring", "");
+        object_t *tail = head;
+        for (size_t i = 1; i < ring_length; i++) {
+            object_t *next = createObject("ring", "");
+            addReference(tail, next);
+            releaseObject(next);
+            tail = next;
+        }
+        addReference(tail, head);
+        releaseObject(head);                            //  Only the ring itself holds it now
+    }
+    collectCycles();
+    double seconds = elapsedSeconds(&start);
+
+    int ok = object_count == live_objects && cycles_freed - freed_before == ring_count * ring_length;
+    printf("live heap %8zu objects: %zu rings x %zu reclaimed in %.3f s  (%.0f objects/sec)  %s\n", live_objects,
+           ring_count, ring_length, seconds, seconds > 0.0 ? (double)(ring_count * ring_length) / seconds : 0.0,
+           ok ? "OK" : "FAILED");
+
+    popRoot();
+    cleanup();
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  Moves random pointers between rooted holders: every move is an increment
+//  and a decrement of the same object, which deferred mode coalesces away
+static void benchShuffle(const char *label, int deferred, size_t moves) {
+    object_t *holders[BENCH_SHUFFLE_HOLDERS];
+    deferred_mode = deferred;
+
+    object_t *root = createObject("shuffle", "");
+    pushRoot(root);
+    releaseObject(root);
+    for (int h = 0; h < BENCH_SHUFFLE_HOLDERS; h++) {
+        holders[h] = createObject("holder", "");
+        addReference(root, holders[h]);
+        releaseObject(holders[h]);
+    }
+    for (int i = 0; i < BENCH_SHUFFLE_OBJECTS; i++) {
+        object_t *object = createObject("object", "");
+        addReference(holders[i % BENCH_SHUFFLE_HOLDERS], object);
+        releaseObject(object);
+    }
+    if (deferred) reconcileCounts(1);
+    else collectCycles();
+    size_t live_objects = object_count;
+    count_updates = 0;
+    buffered_updates = 0;
+
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    for (size_t m = 0; m < moves; m++) {
+        uint64_t random = gcBenchRandom();
+        object_t *from = holders[random % BENCH_SHUFFLE_HOLDERS];
+        object_t *to = holders[(random >> 16) % BENCH_SHUFFLE_HOLDERS];
+        if (from->ref_count == 0) continue;
+
+        object_t *object = from->refs[(random >> 32) % (uint64_t)from->ref_count];
+        addReference(to, object);
+        removeReference(from, object);
+        safePoint();
+    }
+    if (deferred) reconcileCounts(1);
+    else collectCycles();
+    double seconds = elapsedSeconds(&start);
+
+    int ok = object_count == live_objects;
+    printf("%-10s %zu moves in %.3f s  (%.0f moves/sec)  count updates %zu, buffered %zu  %s\n", label, moves,
+           seconds, seconds > 0.0 ? (double)moves / seconds : 0.0, count_updates, buffered_updates,
+           ok ? "OK" : "FAILED");
+
+    popRoot();
+    if (deferred) reconcileCounts(1);
+    ok = ok && object_count == 0;
+    cleanup();
+    deferred_mode = 0;
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  Churn through a live set of BENCH_SLAB_LIVE objects: raw slab allocate/free
+//  against calloc/free of the same size, then full createObject/releaseObject
+//  through handles, checking that every freed object's handle goes stale
+static void benchSlab(size_t pairs) {
+    object_t **live = calloc(BENCH_SLAB_LIVE, sizeof(*live));
+    object_handle_t *handles = calloc(BENCH_SLAB_LIVE, sizeof(*handles));
+    if (!live || !handles) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    for (size_t i = 0; i < pairs; i++) {
+        size_t k = gcBenchRandom() % BENCH_SLAB_LIVE;
+        free(live[k]);
+        live[k] = calloc(1, sizeof(object_t));
+        if (!live[k]) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    double calloc_seconds = elapsedSeconds(&start);
+    for (size_t k = 0; k < BENCH_SLAB_LIVE; k++) free_s((void **)&live[k]);
+
+    timespec_get(&start, TIME_UTC);
+    for (size_t i = 0; i < pairs; i++) {
+        size_t k = gcBenchRandom() % BENCH_SLAB_LIVE;
+        if (live[k]) slabFree(live[k]);
+        live[k] = slabAllocate();
+    }
+    double slab_seconds = elapsedSeconds(&start);
+    for (size_t k = 0; k < BENCH_SLAB_LIVE; k++) slabFree(live[k]);
+
+    printf("calloc/free   %zu pairs in %.3f s  (%.1f M pairs/sec)\n", pairs, calloc_seconds,
+           calloc_seconds > 0.0 ? (double)pairs / calloc_seconds / 1e6 : 0.0);
+    printf("slab          %zu pairs in %.3f s  (%.1f M pairs/sec)  %zu slabs for %d live objects\n", pairs,
+           slab_seconds, slab_seconds > 0.0 ? (double)pairs / slab_seconds / 1e6 : 0.0, slab_count, BENCH_SLAB_LIVE);
+
+    size_t stale_detected = 0, churn = pairs / 10;
+    timespec_get(&start, TIME_UTC);
+    for (size_t i = 0; i < churn; i++) {
+        size_t k = gcBenchRandom() % BENCH_SLAB_LIVE;
+        object_handle_t old_handle = handles[k];
+        releaseObject(resolveHandle(old_handle));
+        if (old_handle != OBJECT_HANDLE_NULL && resolveHandle(old_handle) == NULL) stale_detected++;
+        handles[k] = objectHandle(createObject("churn", ""));
+    }
+    double object_seconds = elapsedSeconds(&start);
+    size_t replaced = 0;
+    for (size_t k = 0; k < BENCH_SLAB_LIVE; k++) replaced += resolveHandle(handles[k]) != NULL;
+    size_t expected_stale = churn - (churn < BENCH_SLAB_LIVE ? churn : BENCH_SLAB_LIVE);
+    int ok = object_count == replaced && stale_detected >= expected_stale && slab_count <= BENCH_SLAB_LIVE / SLAB_SLOTS + 1;
+
+    printf("objects       %zu create/release pairs in %.3f s  (%.1f M pairs/sec)  %zu stale handles detected  %s\n",
+           churn, object_seconds, object_seconds > 0.0 ? (double)churn / object_seconds / 1e6 : 0.0, stale_detected,
+           ok ? "OK" : "FAILED");
+
+    free(live);
+    free(handles);
+    cleanup();
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  Cache of weak handles keyed by id; only the BENCH_WEAK_STRONG most recently
+//  used objects are held strongly. Dead entries are refilled on lookup, so
+//  the cache never keeps an evicted object (or its memory) alive.
+static void benchWeakCache(size_t lookups, size_t key_count) {
+    weak_ref_t **cache = calloc(key_count, sizeof(*cache));
+    object_t **recent = calloc(BENCH_WEAK_STRONG, sizeof(*recent));
+    if (!cache || !recent) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t hits = 0, peak_live = 0, peak_entries = 0;
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    for (size_t i = 0; i < lookups; i++) {
+        size_t key = gcBenchRandom() % key_count;
+        object_t *object = lockWeakRef(cache[key]);
+        if (object) {
+            hits++;
+        } else {
+            releaseWeakRef(cache[key]);
+            object = createObject("cached", "");
+            cache[key] = createWeakRef(object);
+        }
+
+        //  The LRU slot takes over our strong reference
+        size_t slot = i % BENCH_WEAK_STRONG;
+        releaseObject(recent[slot]);
+        recent[slot] = object;
+        if (object_count > peak_live) peak_live = object_count;
+        if (weak_refs_live > peak_entries) peak_entries = weak_refs_live;
+    }
+    double seconds = elapsedSeconds(&start);
+
+    for (size_t i = 0; i < BENCH_WEAK_STRONG; i++) releaseObject(recent[i]);
+    size_t left_alive = object_count;
+    for (size_t i = 0; i < key_count; i++) releaseWeakRef(cache[i]);
+    int ok = left_alive == 0 && weak_refs_live == 0 && peak_live <= BENCH_WEAK_STRONG;
+
+    printf("%zu lookups over %zu keys in %.3f s  (%.0f lookups/sec)  hit rate %.1f%%  %s\n", lookups, key_count,
+           seconds, seconds > 0.0 ? (double)lookups / seconds : 0.0,
+           lookups ? 100.0 * (double)hits / (double)lookups : 0.0, ok ? "OK" : "FAILED");
+    printf("peak live objects %zu (strong set %d), peak side table entries %zu\n", peak_live, BENCH_WEAK_STRONG,
+           peak_entries);
+
+    free(cache);
+    free(recent);
+    cleanup();
+    if (!ok) exit(EXIT_FAILURE);
+}
+
+//  Worker: mostly pairs on objects it owns, every BENCH_THREADS_REMOTE_EVERY-th
+//  pair on one of the main thread's objects; then it drops everything
+static int biasedWorkerMain(void *arg) {
+    biased_worker_t *self = arg;
+    shared_object_t *local[BENCH_THREADS_LOCAL_OBJECTS];
+    shared_object_t *batch_objects[BENCH_THREADS_LOCAL_OBJECTS];
+    biasedAttachThread(self->id);
+
+    //  Retain a whole batch before releasing it, so the pairs cannot cancel
+    //  out in the compiler
+    for (int i = 0; i < BENCH_THREADS_LOCAL_OBJECTS; i++) local[i] = createSharedObject();
+    for (size_t done = 0; done < self->pairs; done += BENCH_THREADS_LOCAL_OBJECTS) {
+        size_t batch = self->pairs - done < BENCH_THREADS_LOCAL_OBJECTS ? self->pairs - done : BENCH_THREADS_LOCAL_OBJECTS;
+        for (size_t i = 0; i < batch; i++) {
+            size_t p = done + i;
+            batch_objects[i] = p % BENCH_THREADS_REMOTE_EVERY == 0
+                ? self->shared[(p / BENCH_THREADS_REMOTE_EVERY) % BENCH_THREADS_SHARED_OBJECTS]
+                : local[i];
+            retainShared(batch_objects[i]);
+        }
+        for (size_t i = 0; i < batch; i++) releaseShared(batch_objects[i]);
+    }
+
+    for (int i = 0; i < BENCH_THREADS_LOCAL_OBJECTS; i++) releaseShared(local[i]);
+    for (int i = 0; i < BENCH_THREADS_SHARED_OBJECTS; i++) releaseShared(self->shared[i]);
+    processMergeQueue();
+    atomic_fetch_sub_explicit(&biased_workers_running, 1, memory_order_release);
+    return 0;
+}
+
+//  Multi-threaded retain/release stress: the main thread owns the shared
+//  objects, hands each worker a reference to all of them and keeps draining
+//  its merge queue and using them while the workers run. Every object must
+//  be freed exactly once by the end. Returns pairs per second.
+static double benchThreads(const char *label, int biased, int thread_count, size_t pairs) {
+    shared_object_t *shared[BENCH_THREADS_SHARED_OBJECTS];
+    biased_worker_t *workers = calloc((size_t)thread_count, sizeof(*workers));
+    if (!workers) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    shared_objects_biased = biased;
+    biasedAttachThread(0);
+    for (int i = 0; i < BENCH_THREADS_SHARED_OBJECTS; i++) shared[i] = createSharedObject();
+    for (int i = 0; i < BENCH_THREADS_SHARED_OBJECTS; i++) {
+        for (int t = 0; t < thread_count; t++) retainShared(shared[i]);
+    }
+
+    struct timespec start;
+    timespec_get(&start, TIME_UTC);
+    atomic_store(&biased_workers_running, thread_count);
+    for (int t = 0; t < thread_count; t++) {
+        workers[t].id = (uint32_t)(t + 1);
+        workers[t].pairs = pairs;
+        workers[t].shared = shared;
+        if (thrd_create(&workers[t].thread, biasedWorkerMain, &workers[t]) != thrd_success) {
+            fprintf(stderr, "ERROR: Could not start worker thread %d\n", t);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t owner_pairs = 0;
+    while (atomic_load_explicit(&biased_workers_running, memory_order_acquire) > 0) {
+        for (int i = 0; i < BENCH_THREADS_OWNER_PAIRS; i++, owner_pairs++) {
+            retainShared(shared[i % BENCH_THREADS_SHARED_OBJECTS]);
+            releaseShared(shared[i % BENCH_THREADS_SHARED_OBJECTS]);
+        }
+        processMergeQueue();
+        thrd_yield();
+    }
+    for (int t = 0; t < thread_count; t++) thrd_join(workers[t].thread, NULL);
+    double seconds = elapsedSeconds(&start);
+
+    processMergeQueue();
+    for (int i = 0; i < BENCH_THREADS_SHARED_OBJECTS; i++) releaseShared(shared[i]);
+    processMergeQueue();
+
+    size_t total = pairs * (size_t)thread_count;
+    size_t leaked = atomic_load(&shared_objects_live);
+    double rate = seconds > 0.0 ? (double)total / seconds : 0.0;
+    printf("%-7s %d threads: %zu retain/release pairs in %.3f s  (%.1f M pairs/sec, %zu by the owner)  %s\n", label,
+           thread_count, total, seconds, rate / 1e6, owner_pairs, leaked == 0 ? "OK" : "FAILED");
+
+    free(workers);
+    if (leaked != 0) {
+        fprintf(stderr, "ERROR: %zu shared objects were not freed\n", leaked);
+        exit(EXIT_FAILURE);
+    }
+    return rate;
 }
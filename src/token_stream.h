@@ -0,0 +1,328 @@
+/*
+Token Stream Format (C17, header-only)
+
+Compact binary token file written by lexer.exe --binary (and --batch -b),
+read back by lexer.exe --dump. A reader maps the file and walks the token
+records in place; nothing is parsed but the varints. Layout, little-endian:
+
+    token_stream_header_t header
+    uint8_t record[token_bytes]                 one varint record per token
+    uint8_t padding[0..3]                       up to a 4-byte boundary
+    uint32_t string_offset[string_count + 1]    offsets into string_data
+    char string_data[string_bytes]              distinct token texts, not
+                                                NUL-terminated
+
+Each token's text is interned once in the string table; the string's
+length is the token's length. A record is delta-encoded against the
+previous token, starting from offset 0, line 1, column 1:
+
+    varint  gap << 4 | new_line << 3 | kind     gap = offset - end of the
+                                                previous token
+    varint  string                              index into the string table
+    varint  line delta, varint column           only when new_line is set;
+                                                otherwise the column moves
+                                                with the offset
+
+So a typical token takes two or three bytes. Varints are LEB128: 7 bits
+per byte, low bits first, high bit set on all but the last byte.
+
+Code Structure:
+Includes
+Constants & Macros
+Struct Definitions
+Function Definitions
+*/
+
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+//  Includes
+#include "lexer.h"
+
+//  Constants & Macros
+#define TOKEN_STREAM_MAGIC "LEXTOK1"                    //  8 bytes with the terminator
+#define TOKEN_STREAM_INITIAL_CAPACITY 65536
+#define TOKEN_STREAM_MAX_RECORD 20                      //  6-byte head, 5-byte string and line delta, 3-byte column
+#define TOKEN_STREAM_KIND_BITS 3
+#define TOKEN_STREAM_NEW_LINE (1u << TOKEN_STREAM_KIND_BITS)
+#define TOKEN_STREAM_GAP_SHIFT (TOKEN_STREAM_KIND_BITS + 1)
+
+_Static_assert(TOKEN_KIND_COUNT <= (1 << TOKEN_STREAM_KIND_BITS), "token kinds must fit the record's kind bits");
+
+//  Struct Definitions
+typedef struct TokenStreamHeader {
+    char magic[8];
+    uint64_t source_length;
+    uint64_t token_count;
+    uint64_t token_bytes;
+    uint64_t string_count;
+    uint64_t string_bytes;
+} token_stream_header_t;
+
+//  Encoder: records go into one growable buffer behind room for the header,
+//  and the string table is appended on save, so the file is one fwrite()
+typedef struct TokenStreamWriter {
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    intern_table_t strings;
+    uint32_t *symbol_strings;                           //  Lexer symbol id -> 1 + string id, 0 = not seen yet
+    uint32_t symbol_capacity;
+    uint64_t token_count;
+    uint64_t source_length;
+    uint32_t end;                                       //  End offset of the previous token
+    uint32_t offset;
+    uint32_t line;
+    uint32_t column;
+} token_stream_writer_t;
+
+//  A stream file opened for reading: the mapped file and its sections
+typedef struct TokenStream {
+    source_buffer_t file;
+    const token_stream_header_t *header;
+    const uint8_t *records;
+    const uint32_t *string_offsets;
+    const char *string_data;
+} token_stream_t;
+
+//  Read position in a stream plus the state the deltas are taken against
+typedef struct TokenStreamCursor {
+    const token_stream_t *stream;
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t offset;
+    uint32_t line;
+    uint32_t column;
+    uint32_t token_end;
+} token_stream_cursor_t;
+
+//  One decoded token; its text is tokenStreamText(stream, string)
+typedef struct TokenRecord {
+    uint32_t offset;
+    uint32_t string;
+    uint32_t line;
+    uint16_t column;                                    //  Saturates at UINT16_MAX, as in token_t
+    uint8_t kind;                                       //  token_kind_t
+} token_record_t;
+
+//  Function Definitions
+static inline uint8_t *tokenStreamPutVarint(uint8_t *p, uint64_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+//  Returns NULL if the varint runs past end or over 64 bits
+static inline const uint8_t *tokenStreamGetVarint(const uint8_t *p, const uint8_t *end, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static inline void tokenStreamWriterInit(token_stream_writer_t *writer, size_t source_length) {
+    memset(writer, 0, sizeof(*writer));
+    writer->capacity = TOKEN_STREAM_INITIAL_CAPACITY;
+    writer->data = malloc(writer->capacity);
+    if (!writer->data) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    writer->length = sizeof(token_stream_header_t);
+    initInternTable(&writer->strings);
+    writer->source_length = source_length;
+    writer->line = 1;
+    writer->column = 1;
+}
+
+static inline void tokenStreamReserve(token_stream_writer_t *writer, size_t bytes) {
+    if (writer->capacity - writer->length >= bytes) return;
+    size_t new_capacity = writer->capacity * 2;
+    while (new_capacity - writer->length < bytes) new_capacity *= 2;
+    uint8_t *data = realloc(writer->data, new_capacity);
+    if (!data) {
+        fprintf(stderr, "ERROR: Memory allocation failed.\n");
+        exit(EXIT_FAILURE);
+    }
+    writer->data = data;
+    writer->capacity = new_capacity;
+}
+
+//  String id of a token's text. Identifiers are looked up by their lexer
+//  symbol, so each distinct one is hashed only once.
+static inline uint32_t tokenStreamString(token_stream_writer_t *writer, const token_t *token, const char *text,
+                                         size_t length) {
+    if (token->kind != TOKEN_IDENTIFIER) return internIdentifier(&writer->strings, text, length);
+    if (token->symbol >= writer->symbol_capacity) {
+        uint32_t new_capacity = writer->symbol_capacity ? writer->symbol_capacity : INTERN_INITIAL_SLOTS;
+        while (new_capacity <= token->symbol) new_capacity *= 2;
+        uint32_t *symbol_strings = realloc(writer->symbol_strings, new_capacity * sizeof(*symbol_strings));
+        if (!symbol_strings) {
+            fprintf(stderr, "ERROR: Memory allocation failed.\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(symbol_strings + writer->symbol_capacity, 0,
+               (new_capacity - writer->symbol_capacity) * sizeof(*symbol_strings));
+        writer->symbol_strings = symbol_strings;
+        writer->symbol_capacity = new_capacity;
+    }
+    uint32_t *string = &writer->symbol_strings[token->symbol];
+    if (!*string) *string = internIdentifier(&writer->strings, text, length) + 1;
+    return *string - 1;
+}
+
+//  Append one lexer token; text is its tokenText()
+static inline void tokenStreamWrite(token_stream_writer_t *writer, const token_t *token, const char *text,
+                                    size_t length) {
+    uint32_t string = tokenStreamString(writer, token, text, length);
+    uint32_t same_line_column = writer->column + (token->offset - writer->offset);
+    if (same_line_column > UINT16_MAX) same_line_column = UINT16_MAX;
+    uint32_t new_line = token->line != writer->line || token->column != same_line_column;
+
+    tokenStreamReserve(writer, TOKEN_STREAM_MAX_RECORD);
+    uint8_t *p = writer->data + writer->length;
+    uint32_t gap = token->offset - writer->end;
+    uint64_t head = (uint64_t)gap << TOKEN_STREAM_GAP_SHIFT | (new_line ? TOKEN_STREAM_NEW_LINE : 0) | token->kind;
+    p = tokenStreamPutVarint(p, head);
+    p = tokenStreamPutVarint(p, string);
+    if (new_line) {
+        p = tokenStreamPutVarint(p, token->line - writer->line);
+        p = tokenStreamPutVarint(p, token->column);
+    }
+    writer->length = (size_t)(p - writer->data);
+    writer->token_count++;
+    writer->end = token->offset + (uint32_t)length;
+    writer->offset = token->offset;
+    writer->line = token->line;
+    writer->column = token->column;
+}
+
+//  Append the string table, fill in the header and write the whole stream
+//  to out (opened "wb") in one call. Returns 1 on success.
+static inline int tokenStreamSave(token_stream_writer_t *writer, FILE *out) {
+    const intern_table_t *strings = &writer->strings;
+    size_t records = writer->length - sizeof(token_stream_header_t);
+    size_t offsets_bytes = ((size_t)strings->count + 1) * sizeof(uint32_t);
+    tokenStreamReserve(writer, 3 + offsets_bytes + strings->text_length);
+    while (writer->length % sizeof(uint32_t)) writer->data[writer->length++] = 0;
+
+    //  Symbols sit in id order in the text pool, so their offsets are the table
+    uint32_t *offsets = (uint32_t *)(writer->data + writer->length);
+    for (uint32_t i = 0; i < strings->count; ++i) offsets[i] = strings->symbols[i].offset;
+    offsets[strings->count] = (uint32_t)strings->text_length;
+    writer->length += offsets_bytes;
+    if (strings->text_length) memcpy(writer->data + writer->length, strings->text, strings->text_length);
+    writer->length += strings->text_length;
+
+    token_stream_header_t header = { TOKEN_STREAM_MAGIC, writer->source_length, writer->token_count, records,
+                                     strings->count, strings->text_length };
+    memcpy(writer->data, &header, sizeof(header));
+
+    return fwrite(writer->data, 1, writer->length, out) == writer->length;
+}
+
+static inline void tokenStreamWriterFree(token_stream_writer_t *writer) {
+    free(writer->data);
+    free(writer->symbol_strings);
+    freeInternTable(&writer->strings);
+    memset(writer, 0, sizeof(*writer));
+}
+
+//  Map a stream file and locate its sections. Returns 0 if the file cannot
+//  be opened or is not a well-formed token stream.
+static inline int openTokenStream(const char *filename, token_stream_t *stream) {
+    memset(stream, 0, sizeof(*stream));
+    if (!openSource(filename, 1, &stream->file)) return 0;
+    const token_stream_header_t *header = (const token_stream_header_t *)stream->file.data;
+    size_t length = stream->file.length;
+    if (length < sizeof(*header) || memcmp(header->magic, TOKEN_STREAM_MAGIC, sizeof(header->magic)) != 0 ||
+        header->token_bytes > length || header->string_count >= UINT32_MAX || header->string_bytes > UINT32_MAX) {
+        closeSource(&stream->file);
+        return 0;
+    }
+    size_t strings = (sizeof(*header) + (size_t)header->token_bytes + 3) & ~(size_t)3;
+    size_t offsets_bytes = ((size_t)header->string_count + 1) * sizeof(uint32_t);
+    if (strings + offsets_bytes + (size_t)header->string_bytes != length) {
+        closeSource(&stream->file);
+        return 0;
+    }
+    stream->header = header;
+    stream->records = (const uint8_t *)stream->file.data + sizeof(*header);
+    stream->string_offsets = (const uint32_t *)(stream->file.data + strings);
+    stream->string_data = stream->file.data + strings + offsets_bytes;
+    for (uint64_t i = 0; i < header->string_count; ++i) {
+        if (stream->string_offsets[i] > stream->string_offsets[i + 1]) {
+            closeSource(&stream->file);
+            return 0;
+        }
+    }
+    if (stream->string_offsets[header->string_count] != header->string_bytes) {
+        closeSource(&stream->file);
+        return 0;
+    }
+    return 1;
+}
+
+static inline void closeTokenStream(token_stream_t *stream) {
+    closeSource(&stream->file);
+    memset(stream, 0, sizeof(*stream));
+}
+
+static inline const char *tokenStreamText(const token_stream_t *stream, uint32_t string, size_t *length) {
+    *length = stream->string_offsets[string + 1] - stream->string_offsets[string];
+    return stream->string_data + stream->string_offsets[string];
+}
+
+static inline void tokenStreamBegin(const token_stream_t *stream, token_stream_cursor_t *cursor) {
+    cursor->stream = stream;
+    cursor->p = stream->records;
+    cursor->end = stream->records + stream->header->token_bytes;
+    cursor->offset = 0;
+    cursor->line = 1;
+    cursor->column = 1;
+    cursor->token_end = 0;
+}
+
+//  Decode the next record into *record. Returns 0 at the end of the stream
+//  or on a malformed record.
+static inline int tokenStreamNext(token_stream_cursor_t *cursor, token_record_t *record) {
+    uint64_t head, string, line_delta, column;
+    const uint8_t *p = cursor->p;
+    if (p >= cursor->end) return 0;
+    if (!(p = tokenStreamGetVarint(p, cursor->end, &head))) return 0;
+    if (!(p = tokenStreamGetVarint(p, cursor->end, &string))) return 0;
+    if (string >= cursor->stream->header->string_count) return 0;
+
+    uint32_t offset = cursor->token_end + (uint32_t)(head >> TOKEN_STREAM_GAP_SHIFT);
+    if (head & TOKEN_STREAM_NEW_LINE) {
+        if (!(p = tokenStreamGetVarint(p, cursor->end, &line_delta))) return 0;
+        if (!(p = tokenStreamGetVarint(p, cursor->end, &column))) return 0;
+        cursor->line += (uint32_t)line_delta;
+    } else {
+        column = cursor->column + (offset - cursor->offset);
+    }
+    if (column > UINT16_MAX) column = UINT16_MAX;
+    const uint32_t *offsets = cursor->stream->string_offsets;
+    cursor->p = p;
+    cursor->offset = offset;
+    cursor->column = (uint32_t)column;
+    cursor->token_end = offset + (offsets[string + 1] - offsets[string]);
+
+    record->offset = offset;
+    record->string = (uint32_t)string;
+    record->line = cursor->line;
+    record->column = (uint16_t)column;
+    record->kind = (uint8_t)(head & ((1u << TOKEN_STREAM_KIND_BITS) - 1));
+    return 1;
+}
+
+#endif // TOKEN_STREAM_H